@@ -4,6 +4,7 @@
 #include "raylib.h"
 #include "math.h"
 #include "aiUtils.h"
+#include "rng.h"
 
 class AttackEnemyState : public State
 {
@@ -58,7 +59,7 @@ public:
       else
       {
         // do a random walk
-        a.action = GetRandomValue(EA_MOVE_START, EA_MOVE_END - 1);
+        a.action = rng::rand_int(EA_MOVE_START, EA_MOVE_END - 1);
       }
     });
   }
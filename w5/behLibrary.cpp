@@ -3,6 +3,7 @@
 #include "aiUtils.h"
 #include "math.h"
 #include "raylib.h"
+#include "rng.h"
 #include "blackboard.h"
 #include <algorithm>
 
@@ -219,7 +220,7 @@ struct Patrol : public BehNode
       if (dist(pos, patrolPos) > patrolDist)
         a.action = move_towards(pos, patrolPos);
       else
-        a.action = GetRandomValue(EA_MOVE_START, EA_MOVE_END - 1); // do a random walk
+        a.action = rng::rand_int(EA_MOVE_START, EA_MOVE_END - 1); // do a random walk
     });
     return res;
   }
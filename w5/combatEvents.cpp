@@ -0,0 +1,79 @@
+#include "combatEvents.h"
+#include "ecsTypes.h"
+
+CombatEvents *combat::begin_turn(flecs::world &ecs)
+{
+  static auto eventsQuery = ecs.query<CombatEvents, const TurnCounter>();
+  CombatEvents *res = nullptr;
+  eventsQuery.each([&](CombatEvents &events, const TurnCounter &c)
+  {
+    events.clear();
+    events.turn = c.count;
+    res = &events;
+  });
+  return res;
+}
+
+void combat::apply_hitpoint_events(CombatEvents &events)
+{
+  // heals go first, as a monster healing itself this turn should survive a hit it can take
+  const HealEvents &heals = events.heals;
+  for (size_t i = 0; i < heals.size(); ++i)
+    if (Hitpoints *hp = heals.target[i].get_mut<Hitpoints>())
+      hp->hitpoints += heals.amount[i];
+
+  const AttackEvents &attacks = events.attacks;
+  for (size_t i = 0; i < attacks.size(); ++i)
+  {
+    Hitpoints *hp = attacks.target[i].get_mut<Hitpoints>();
+    if (!hp)
+      continue;
+    const bool wasAlive = hp->hitpoints > 0.f;
+    hp->hitpoints -= attacks.damage[i];
+    events.damage.push(attacks.attacker[i], attacks.target[i], attacks.damage[i]);
+    if (wasAlive && hp->hitpoints <= 0.f) // only the killing blow, so every death is reported once
+      events.deaths.entity.push_back(attacks.target[i]);
+  }
+}
+
+void combat::apply_pickup_events(CombatEvents &events)
+{
+  const PickupEvents &pickups = events.pickups;
+  for (size_t i = 0; i < pickups.size(); ++i)
+  {
+    if (pickups.kind[i] == PICKUP_HEAL)
+    {
+      if (Hitpoints *hp = pickups.picker[i].get_mut<Hitpoints>())
+        hp->hitpoints += pickups.amount[i];
+    }
+    else if (MeleeDamage *dmg = pickups.picker[i].get_mut<MeleeDamage>())
+      dmg->damage += pickups.amount[i];
+  }
+}
+
+void combat::log_combat_events(flecs::world &ecs, const CombatEvents &events)
+{
+  static auto queryLog = ecs.query<ActionLog>();
+  queryLog.each([&](ActionLog &log)
+  {
+    const HealEvents &heals = events.heals;
+    for (size_t i = 0; i < heals.size(); ++i)
+      log.push({events.turn, LOG_HEAL_SELF, heals.target[i].id(), heals.target[i].id(), heals.amount[i]});
+    const DamageEvents &damage = events.damage;
+    for (size_t i = 0; i < damage.size(); ++i)
+      log.push({events.turn, LOG_DAMAGE, damage.source[i].id(), damage.target[i].id(), damage.amount[i]});
+    for (flecs::entity e : events.deaths.entity)
+      log.push({events.turn, LOG_DEATH, e.id(), e.id(), 0.f});
+  });
+}
+
+void combat::cleanup_combat_events(flecs::world &ecs, const CombatEvents &events)
+{
+  ecs.defer([&]
+  {
+    for (flecs::entity e : events.deaths.entity)
+      e.destruct();
+    for (flecs::entity item : events.pickups.item)
+      item.destruct();
+  });
+}
@@ -0,0 +1,118 @@
+#pragma once
+#include <flecs.h>
+#include <cstdint>
+#include <vector>
+
+// Combat events of one turn, one SoA buffer per kind. Action resolution only appends here,
+// hitpoints, the log and entity removal are then updated by separate passes over whole buffers.
+// Buffers live on the "world" entity and keep their capacity between turns.
+struct AttackEvents
+{
+  std::vector<flecs::entity> attacker;
+  std::vector<flecs::entity> target;
+  std::vector<float> damage;
+
+  void push(flecs::entity from, flecs::entity to, float dmg)
+  {
+    attacker.push_back(from);
+    target.push_back(to);
+    damage.push_back(dmg);
+  }
+  size_t size() const { return target.size(); }
+  void clear() { attacker.clear(); target.clear(); damage.clear(); }
+};
+
+// hitpoints actually taken by attacks, filled from AttackEvents when they are applied
+struct DamageEvents
+{
+  std::vector<flecs::entity> source;
+  std::vector<flecs::entity> target;
+  std::vector<float> amount;
+
+  void push(flecs::entity from, flecs::entity to, float amt)
+  {
+    source.push_back(from);
+    target.push_back(to);
+    amount.push_back(amt);
+  }
+  size_t size() const { return target.size(); }
+  void clear() { source.clear(); target.clear(); amount.clear(); }
+};
+
+struct HealEvents
+{
+  std::vector<flecs::entity> target;
+  std::vector<float> amount;
+
+  void push(flecs::entity to, float amt)
+  {
+    target.push_back(to);
+    amount.push_back(amt);
+  }
+  size_t size() const { return target.size(); }
+  void clear() { target.clear(); amount.clear(); }
+};
+
+enum PickupKind : uint8_t
+{
+  PICKUP_HEAL,
+  PICKUP_POWERUP
+};
+
+struct PickupEvents
+{
+  std::vector<flecs::entity> picker;
+  std::vector<flecs::entity> item;
+  std::vector<PickupKind> kind;
+  std::vector<float> amount;
+
+  void push(flecs::entity who, flecs::entity what, PickupKind k, float amt)
+  {
+    picker.push_back(who);
+    item.push_back(what);
+    kind.push_back(k);
+    amount.push_back(amt);
+  }
+  size_t size() const { return item.size(); }
+  void clear() { picker.clear(); item.clear(); kind.clear(); amount.clear(); }
+};
+
+struct DeathEvents
+{
+  std::vector<flecs::entity> entity;
+
+  size_t size() const { return entity.size(); }
+  void clear() { entity.clear(); }
+};
+
+struct CombatEvents
+{
+  int turn = 0;
+  AttackEvents attacks;
+  DamageEvents damage;
+  HealEvents heals;
+  PickupEvents pickups;
+  DeathEvents deaths;
+
+  void clear()
+  {
+    attacks.clear();
+    damage.clear();
+    heals.clear();
+    pickups.clear();
+    deaths.clear();
+  }
+};
+
+namespace combat
+{
+  CombatEvents *begin_turn(flecs::world &ecs);
+
+  // attacks and heals -> hitpoints, fills damage and deaths
+  void apply_hitpoint_events(CombatEvents &events);
+  // pickups -> hitpoints and melee damage of the pickers
+  void apply_pickup_events(CombatEvents &events);
+  void log_combat_events(flecs::world &ecs, const CombatEvents &events);
+  // destroys dead entities and picked up items
+  void cleanup_combat_events(flecs::world &ecs, const CombatEvents &events);
+};
@@ -18,7 +18,7 @@ static void query_characters_positions(flecs::world &ecs, Callable c)
   characterPositionQuery.each(c);
 }
 
-constexpr float invalid_tile_value = 1e5f;
+using dmaps::invalid_tile_value;
 
 static void init_tiles(std::vector<float> &map, const DungeonData &dd)
 {
@@ -46,6 +46,11 @@ static void process_dmap(std::vector<float> &map, const DungeonData &dd)
     val = std::min(val, getMapAt(x + 0, y + 1, val));
     return val;
   };
+  // values only spread inside a region, so regions without a finite tile stay invalid and aren't scanned
+  std::vector<bool> activeRegion(dd.regions.regionSize.size(), false);
+  for (size_t i = 0; i < map.size(); ++i)
+    if (map[i] < invalid_tile_value && dd.regions.tileRegion[i] != dungeon::no_region)
+      activeRegion[dd.regions.tileRegion[i]] = true;
   while (!done)
   {
     done = true;
@@ -53,7 +58,8 @@ static void process_dmap(std::vector<float> &map, const DungeonData &dd)
       for (size_t x = 0; x < dd.width; ++x)
       {
         const size_t i = y * dd.width + x;
-        if (dd.tiles[i] != dungeon::floor)
+        const uint32_t region = dd.regions.tileRegion[i];
+        if (region == dungeon::no_region || !activeRegion[region])
           continue;
         const float myVal = getMapAt(x, y, invalid_tile_value);
         const float minVal = getMinNei(x, y);
@@ -4,6 +4,8 @@
 
 namespace dmaps
 {
+  constexpr float invalid_tile_value = 1e5f; // walls and tiles no source can reach
+
   void gen_player_approach_map(flecs::world &ecs, std::vector<float> &map);
   void gen_player_flee_map(flecs::world &ecs, std::vector<float> &map);
   void gen_hive_pack_map(flecs::world &ecs, std::vector<float> &map);
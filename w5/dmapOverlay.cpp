@@ -0,0 +1,115 @@
+#include "dmapOverlay.h"
+#include "ecsTypes.h"
+#include "dijkstraMapGen.h"
+#include "roguelike.h"
+#include "viewCulling.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+constexpr int overlay_label_radius = 3; // in tiles around the cursor
+
+void gather_dmap_overlay_values(flecs::world &ecs, flecs::entity e, std::vector<float> &values, size_t num_tiles)
+{
+  values.assign(num_tiles, dmaps::invalid_tile_value);
+  if (const DijkstraMapData *dmap = e.get<DijkstraMapData>())
+  {
+    std::copy_n(dmap->map.begin(), std::min(num_tiles, dmap->map.size()), values.begin());
+    return;
+  }
+  const DmapWeights *wt = e.get<DmapWeights>();
+  if (!wt)
+    return;
+  std::fill(values.begin(), values.end(), 0.f);
+  for (const auto &pair : wt->weights)
+  {
+    const DijkstraMapData *dmap = ecs.entity(pair.first.c_str()).get<DijkstraMapData>();
+    if (!dmap || dmap->map.size() < num_tiles)
+      continue;
+    for (size_t i = 0; i < num_tiles; ++i)
+    {
+      const float v = dmap->map[i];
+      values[i] += v < dmaps::invalid_tile_value ? powf(v * pair.second.mult, pair.second.pow) : v;
+    }
+  }
+}
+
+// green close to the sources, red far away, unreachable tiles are transparent
+static void update_texture(DmapOverlay &overlay, size_t w, size_t h)
+{
+  float minVal = FLT_MAX;
+  float maxVal = -FLT_MAX;
+  for (float v : overlay.values)
+    if (v < dmaps::invalid_tile_value)
+    {
+      minVal = std::min(minVal, v);
+      maxVal = std::max(maxVal, v);
+    }
+  const float range = std::max(maxVal - minVal, 1e-3f);
+  std::vector<Color> pixels(w * h);
+  for (size_t i = 0; i < w * h; ++i)
+  {
+    const float v = overlay.values[i];
+    if (v >= dmaps::invalid_tile_value)
+    {
+      pixels[i] = Color{0, 0, 0, 0};
+      continue;
+    }
+    const float t = (v - minVal) / range;
+    pixels[i] = Color{static_cast<unsigned char>(255.f * t), static_cast<unsigned char>(255.f * (1.f - t)), 0, 128};
+  }
+
+  if (overlay.texture.id == 0 || overlay.texture.width != int(w) || overlay.texture.height != int(h))
+  {
+    if (overlay.texture.id != 0)
+      UnloadTexture(overlay.texture);
+    Image image = {pixels.data(), int(w), int(h), 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8};
+    overlay.texture = LoadTextureFromImage(image);
+    SetTextureFilter(overlay.texture, TEXTURE_FILTER_POINT);
+  }
+  else
+    UpdateTexture(overlay.texture, pixels.data());
+  overlay.dirty = false;
+}
+
+void register_dmap_overlay(flecs::world &ecs)
+{
+  static auto dungeonDataQuery = ecs.query<const DungeonData>();
+
+  ecs.observer<DmapOverlay>()
+    .event(flecs::OnRemove)
+    .each([](DmapOverlay &overlay)
+    {
+      if (overlay.texture.id != 0)
+        UnloadTexture(overlay.texture);
+    });
+
+  ecs.system<DmapOverlay>()
+    .each([&](DmapOverlay &overlay)
+    {
+      dungeonDataQuery.each([&](const DungeonData &dd)
+      {
+        if (overlay.values.size() != dd.width * dd.height)
+          return;
+        if (overlay.dirty)
+          update_texture(overlay, dd.width, dd.height);
+        DrawTexturePro(overlay.texture, Rectangle{0.f, 0.f, float(dd.width), float(dd.height)},
+            Rectangle{0.f, 0.f, float(dd.width) * tile_size, float(dd.height) * tile_size}, Vector2{0.f, 0.f}, 0.f,
+            WHITE);
+
+        const VisibleTiles vis = get_visible_tiles(ecs);
+        const int x0 = std::max(vis.cursor.x - overlay_label_radius, vis.x0);
+        const int y0 = std::max(vis.cursor.y - overlay_label_radius, vis.y0);
+        const int x1 = std::min(vis.cursor.x + overlay_label_radius + 1, vis.x1);
+        const int y1 = std::min(vis.cursor.y + overlay_label_radius + 1, vis.y1);
+        for (int y = y0; y < y1; ++y)
+          for (int x = x0; x < x1; ++x)
+          {
+            const float val = overlay.values[size_t(y) * dd.width + size_t(x)];
+            if (val < dmaps::invalid_tile_value)
+              DrawText(TextFormat("%.1f", double(val)),
+                  int((float(x) + 0.2f) * tile_size), int((float(y) + 0.5f) * tile_size), 150, WHITE);
+          }
+      });
+    });
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <flecs.h>
+#include <vector>
+#include "raylib.h"
+
+// Heatmap of a visualised dijkstra map (or a weighted sum of them), one texel per tile.
+// Values come from the simulation snapshots, the texture is rebuilt only when a snapshot brings
+// new ones, drawing is a single quad plus numeric labels around the cursor.
+struct DmapOverlay
+{
+  Texture2D texture = {};
+  std::vector<float> values; // what the overlay shows, per tile
+  bool dirty = true;
+};
+
+// simulation side: values shown for an entity with VisualiseMap and either DijkstraMapData or DmapWeights
+void gather_dmap_overlay_values(flecs::world &ecs, flecs::entity e, std::vector<float> &values, size_t num_tiles);
+// render side: the draw system
+void register_dmap_overlay(flecs::world &ecs);
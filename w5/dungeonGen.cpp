@@ -2,81 +2,167 @@
 #include "dungeonUtils.h"
 #include <cstring> // memset
 #include <cstdio> // printf
-#include <random>
-#include <chrono> // std::chrono
-#include <functional> // std::bind
+#include <algorithm>
+#include <vector>
 #include "ecsTypes.h"
 #include "math.h"
-#include <limits>
+#include "rng.h"
+#include "threadPool.h"
+#include <memory>
 
+// interleaved bits of x and y, sorting by it keeps points which are close on the map close in the list
+static uint64_t morton_key(Position pos)
+{
+  uint64_t res = 0;
+  for (int bit = 0; bit < 32; ++bit)
+  {
+    res |= uint64_t((uint32_t(pos.x) >> bit) & 1u) << (2 * bit);
+    res |= uint64_t((uint32_t(pos.y) >> bit) & 1u) << (2 * bit + 1);
+  }
+  return res;
+}
 
-void gen_drunk_dungeon(char *tiles, size_t w, size_t h)
+static void dig_corridor(char *tiles, size_t w, Position from, Position to)
 {
-  //constexpr char wall = '#';
-  //constexpr char flr = ' ';
+  Position pos = from;
+  while (dist_sq(pos, to) > 0.f)
+  {
+    const Position delta = to - pos;
+    if (abs(delta.x) > abs(delta.y))
+      pos.x += delta.x > 0 ? 1 : -1;
+    else
+      pos.y += delta.y > 0 ? 1 : -1;
+    tiles[size_t(pos.y) * w + size_t(pos.x)] = dungeon::floor;
+  }
+}
 
-  memset(tiles, dungeon::wall, w * h);
+static size_t drunk_chunk_size(const DrunkDungeonParams &params)
+{
+  return std::max(params.chunkSize, size_t(8));
+}
 
-  // generator
-  unsigned seed = unsigned(std::chrono::system_clock::now().time_since_epoch().count() % std::numeric_limits<int>::max());
-  std::default_random_engine seedGenerator(seed);
-  std::default_random_engine widthGenerator(seedGenerator());
-  std::default_random_engine heightGenerator(seedGenerator());
-  std::default_random_engine dirGenerator(seedGenerator());
+static size_t drunk_chunk_count(size_t w, size_t h, const DrunkDungeonParams &params)
+{
+  const size_t chunkSize = drunk_chunk_size(params);
+  return ((w + chunkSize - 1) / chunkSize) * ((h + chunkSize - 1) / chunkSize);
+}
 
-  // distributions
-  std::uniform_int_distribution<size_t> widthDist(1, w-2);
-  std::uniform_int_distribution<size_t> heightDist(1, h-2);
-  std::uniform_int_distribution<size_t> dirDist(0, 3);
-  auto rndWd = std::bind(widthDist, widthGenerator);
-  auto rndHt = std::bind(heightDist, heightGenerator);
-  auto rndDir = std::bind(dirDist, dirGenerator);
+// Every chunk is dug by its own walkers with its own generator, so the result doesn't depend
+// on how chunks are scheduled between threads and the whole map is reproducible from the rng seed.
+void gen_drunk_dungeon(char *tiles, size_t w, size_t h, const DrunkDungeonParams &params, ThreadPool *pool)
+{
+  memset(tiles, dungeon::wall, w * h);
+  if (w < 3 || h < 3)
+    return;
 
-  const int dirs[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+  const size_t chunkSize = drunk_chunk_size(params);
+  const size_t chunksX = (w + chunkSize - 1) / chunkSize;
+  const size_t numChunks = drunk_chunk_count(w, h, params);
+  const size_t numWalkers = params.numWalkers > 0 ? params.numWalkers : std::max(size_t(4), w * h * 4 / 2500);
 
-  constexpr size_t numIter = 4;
-  constexpr size_t maxExcavations = 200;
-  std::vector<Position> startPos;
-  for (size_t iter = 0; iter < numIter; ++iter)
+  // walkable interior of a chunk, map border always stays a wall
+  auto chunkBounds = [&](size_t chunk, size_t &x0, size_t &y0, size_t &x1, size_t &y1)
   {
-    // select random point on map
-    size_t x = rndWd();
-    size_t y = rndHt();
-    startPos.push_back({int(x), int(y)});
-    size_t numExcavations = 0;
-    while (numExcavations < maxExcavations)
-    {
-      if (tiles[y * w + x] == dungeon::wall)
-      {
-        numExcavations++;
-        tiles[y * w + x] = dungeon::floor;
-      }
-      // choose random dir
-      size_t dir = rndDir(); // 0 - right, 1 - up, 2 - left, 3 - down
-      int newX = std::min(std::max(int(x) + dirs[dir][0], 1), int(w) - 2);
-      int newY = std::min(std::max(int(y) + dirs[dir][1], 1), int(h) - 2);
-      x = size_t(newX);
-      y = size_t(newY);
-    }
+    x0 = std::max(chunk % chunksX * chunkSize, size_t(1));
+    y0 = std::max(chunk / chunksX * chunkSize, size_t(1));
+    x1 = std::min((chunk % chunksX + 1) * chunkSize, w - 1);
+    y1 = std::min((chunk / chunksX + 1) * chunkSize, h - 1);
+  };
+  // walkers are given out proportionally to chunk area, rounding on prefix sums keeps the total exact
+  std::vector<size_t> areaPrefix(numChunks + 1, 0);
+  for (size_t chunk = 0; chunk < numChunks; ++chunk)
+  {
+    size_t x0, y0, x1, y1;
+    chunkBounds(chunk, x0, y0, x1, y1);
+    areaPrefix[chunk + 1] = areaPrefix[chunk] + (x1 > x0 && y1 > y0 ? (x1 - x0) * (y1 - y0) : 0);
   }
+  const size_t totalArea = areaPrefix[numChunks];
 
-  // construct a path from start pos to all other start poses
-  for (const Position &spos : startPos)
-    for (const Position &epos : startPos)
+  const uint64_t baseSeed = (uint64_t(rng::next()) << 32) | rng::next();
+  const int dirs[4][2] = {{1, 0}, {0, 1}, {-1, 0}, {0, -1}};
+  std::vector<std::vector<Position>> chunkStarts(numChunks);
+  auto digChunk = [&](size_t chunk)
+  {
+    size_t x0, y0, x1, y1;
+    chunkBounds(chunk, x0, y0, x1, y1);
+    const size_t area = areaPrefix[chunk + 1] - areaPrefix[chunk];
+    if (area == 0)
+      return;
+    const size_t walkersBegin = numWalkers * areaPrefix[chunk] / totalArea;
+    const size_t walkersEnd = numWalkers * areaPrefix[chunk + 1] / totalArea;
+    const size_t maxExcavations = std::min(params.maxExcavations, area);
+    const size_t maxSteps = maxExcavations * 64; // in case other walkers have already dug the chunk out
+
+    rng::Xoshiro256 gen(baseSeed + chunk);
+    for (size_t walker = walkersBegin; walker < walkersEnd; ++walker)
     {
-      Position pos = spos;
-      while (dist_sq(pos, epos) > 0.f)
+      // select random point in the chunk
+      int x = int(x0 + gen.below(uint32_t(x1 - x0)));
+      int y = int(y0 + gen.below(uint32_t(y1 - y0)));
+      chunkStarts[chunk].push_back({x, y});
+      size_t numExcavations = 0;
+      uint64_t dirBits = 0;
+      int dirsLeft = 0;
+      for (size_t step = 0; numExcavations < maxExcavations && step < maxSteps; ++step)
       {
-        const Position delta = epos - pos;
-        if (abs(delta.x) > abs(delta.y))
-          pos.x += delta.x > 0 ? 1 : -1;
-        else
-          pos.y += delta.y > 0 ? 1 : -1;
-        tiles[size_t(pos.y) * w + size_t(pos.x)] = dungeon::floor;
+        char &tile = tiles[size_t(y) * w + size_t(x)];
+        if (tile == dungeon::wall)
+        {
+          numExcavations++;
+          tile = dungeon::floor;
+        }
+        // one generator call gives directions for 32 steps
+        if (dirsLeft == 0)
+        {
+          dirBits = gen.next();
+          dirsLeft = 32;
+        }
+        const size_t dir = dirBits & 3; // 0 - right, 1 - up, 2 - left, 3 - down
+        dirBits >>= 2;
+        dirsLeft--;
+        x = std::min(std::max(x + dirs[dir][0], int(x0)), int(x1) - 1);
+        y = std::min(std::max(y + dirs[dir][1], int(y0)), int(y1) - 1);
       }
     }
+  };
+  if (pool && numChunks > 1)
+    pool->parallelFor(numChunks, digChunk);
+  else
+    for (size_t chunk = 0; chunk < numChunks; ++chunk)
+      digChunk(chunk);
+
+  // connect walkers into a single chain along a space filling curve instead of all pairs
+  std::vector<Position> startPos;
+  for (const std::vector<Position> &starts : chunkStarts)
+    startPos.insert(startPos.end(), starts.begin(), starts.end());
+  std::sort(startPos.begin(), startPos.end(),
+            [](const Position &lhs, const Position &rhs) { return morton_key(lhs) < morton_key(rhs); });
+  for (size_t i = 1; i < startPos.size(); ++i)
+    dig_corridor(tiles, w, startPos[i - 1], startPos[i]);
 
+  if (params.quiet)
+    return;
   for (size_t y = 0; y < h; ++y)
     printf("%.*s\n", int(w), tiles + y * w);
 }
 
+class DrunkDungeonGenerator : public DungeonGenerator
+{
+  DrunkDungeonParams params;
+  // kept between maps, started on the first one with more than one chunk
+  mutable std::unique_ptr<ThreadPool> pool;
+public:
+  DrunkDungeonGenerator(const DrunkDungeonParams &in_params) : params(in_params) {}
+
+  void generate(char *tiles, size_t w, size_t h) const override
+  {
+    if (!pool && drunk_chunk_count(w, h, params) > 1)
+      pool = std::make_unique<ThreadPool>();
+    gen_drunk_dungeon(tiles, w, h, params, pool.get());
+  }
+};
+
+DungeonGenerator *create_drunk_generator(const DrunkDungeonParams &params)
+{
+  return new DrunkDungeonGenerator(params);
+}
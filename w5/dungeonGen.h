@@ -1,4 +1,31 @@
 #pragma once
 #include <cstddef> // size_t
 
-void gen_drunk_dungeon(char *tiles, size_t w, size_t h);
+class ThreadPool;
+
+struct DrunkDungeonParams
+{
+  size_t numWalkers = 0; // 0 - scale with the map, 4 walkers per 50x50 tiles
+  size_t maxExcavations = 200; // per walker
+  size_t chunkSize = 256; // walkers stay inside their chunk, chunks are dug in parallel
+  bool quiet = false; // don't print the map
+};
+
+// chunks are dug on the pool when there's one, on the calling thread otherwise
+void gen_drunk_dungeon(char *tiles, size_t w, size_t h, const DrunkDungeonParams &params = {}, ThreadPool *pool = nullptr);
+
+class DungeonGenerator
+{
+public:
+  virtual ~DungeonGenerator() {}
+  // fills w * h tiles with dungeon::wall and dungeon::floor, randomness comes from the rng service
+  virtual void generate(char *tiles, size_t w, size_t h) const = 0;
+};
+
+DungeonGenerator *create_drunk_generator(const DrunkDungeonParams &params = {});
+// binary space partitioning into leaves with one room each, siblings connected by corridors
+DungeonGenerator *create_bsp_generator(size_t min_leaf_size = 10, size_t min_room_size = 4);
+// cellular automaton caves computed on a bit-packed grid, 64 cells per machine word
+DungeonGenerator *create_cave_generator(float wall_chance = 0.45f, size_t iterations = 5);
+// wave function collapse over 3x3 tiles of rooms and corridors sharing their edges
+DungeonGenerator *create_wfc_generator();
@@ -0,0 +1,112 @@
+#include "dungeonGen.h"
+#include "dungeonUtils.h"
+#include <algorithm>
+#include <cstring> // memset
+#include <vector>
+#include "rng.h"
+
+struct BspRect
+{
+  size_t x0, y0, x1, y1; // half open
+
+  size_t width() const { return x1 - x0; }
+  size_t height() const { return y1 - y0; }
+};
+
+struct BspNode
+{
+  BspRect rect;
+  size_t children[2] = {size_t(-1), size_t(-1)};
+  BspRect room = {}; // only in leaves
+};
+
+static void carve_rect(char *tiles, size_t w, const BspRect &rect)
+{
+  for (size_t y = rect.y0; y < rect.y1; ++y)
+    memset(tiles + y * w + rect.x0, dungeon::floor, rect.width());
+}
+
+// L-shaped corridor, horizontal leg first
+static void carve_corridor(char *tiles, size_t w, size_t fromX, size_t fromY, size_t toX, size_t toY)
+{
+  for (size_t x = std::min(fromX, toX); x <= std::max(fromX, toX); ++x)
+    tiles[fromY * w + x] = dungeon::floor;
+  for (size_t y = std::min(fromY, toY); y <= std::max(fromY, toY); ++y)
+    tiles[y * w + toX] = dungeon::floor;
+}
+
+class BspDungeonGenerator : public DungeonGenerator
+{
+  size_t minLeafSize;
+  size_t minRoomSize;
+public:
+  BspDungeonGenerator(size_t min_leaf, size_t min_room)
+    : minLeafSize(std::max(min_leaf, min_room + 2)), minRoomSize(std::max(min_room, size_t(1))) {}
+
+  void generate(char *tiles, size_t w, size_t h) const override
+  {
+    memset(tiles, dungeon::wall, w * h);
+    if (w < minRoomSize + 4 || h < minRoomSize + 4)
+      return; // every leaf, even an unsplit root, must fit a room and a wall around it
+    rng::Xoshiro256 gen((uint64_t(rng::next()) << 32) | rng::next());
+
+    // split until leaves are too small, nodes are stored in creation order, children after parents
+    std::vector<BspNode> nodes;
+    nodes.push_back({{1, 1, w - 1, h - 1}});
+    for (size_t idx = 0; idx < nodes.size(); ++idx)
+    {
+      const BspRect rect = nodes[idx].rect;
+      const bool canSplitX = rect.width() >= minLeafSize * 2;
+      const bool canSplitY = rect.height() >= minLeafSize * 2;
+      if (!canSplitX && !canSplitY)
+        continue;
+      // prefer cutting across the longer side so leaves stay roughly square
+      const bool splitX = canSplitX && (!canSplitY || rect.width() > rect.height() ||
+                                        (rect.width() == rect.height() && (gen.next() & 1)));
+      const size_t len = splitX ? rect.width() : rect.height();
+      const size_t cut = minLeafSize + gen.below(uint32_t(len - minLeafSize * 2 + 1));
+      BspRect lhs = rect;
+      BspRect rhs = rect;
+      if (splitX)
+        lhs.x1 = rhs.x0 = rect.x0 + cut;
+      else
+        lhs.y1 = rhs.y0 = rect.y0 + cut;
+      nodes[idx].children[0] = nodes.size();
+      nodes[idx].children[1] = nodes.size() + 1;
+      nodes.push_back({lhs});
+      nodes.push_back({rhs});
+    }
+
+    // rooms in leaves, one tile of wall around them so neighbouring rooms don't merge
+    for (BspNode &node : nodes)
+    {
+      if (node.children[0] != size_t(-1))
+        continue;
+      const BspRect &rect = node.rect;
+      const size_t roomW = minRoomSize + gen.below(uint32_t(rect.width() - 2 - minRoomSize + 1));
+      const size_t roomH = minRoomSize + gen.below(uint32_t(rect.height() - 2 - minRoomSize + 1));
+      const size_t roomX = rect.x0 + 1 + gen.below(uint32_t(rect.width() - 2 - roomW + 1));
+      const size_t roomY = rect.y0 + 1 + gen.below(uint32_t(rect.height() - 2 - roomH + 1));
+      node.room = {roomX, roomY, roomX + roomW, roomY + roomH};
+      carve_rect(tiles, w, node.room);
+    }
+
+    // bottom up, every inner node connects a random room of each subtree and takes one of them up
+    for (size_t idx = nodes.size(); idx-- > 0;)
+    {
+      BspNode &node = nodes[idx];
+      if (node.children[0] == size_t(-1))
+        continue;
+      const BspRect &lhs = nodes[node.children[0]].room;
+      const BspRect &rhs = nodes[node.children[1]].room;
+      carve_corridor(tiles, w, lhs.x0 + gen.below(uint32_t(lhs.width())), lhs.y0 + gen.below(uint32_t(lhs.height())),
+                     rhs.x0 + gen.below(uint32_t(rhs.width())), rhs.y0 + gen.below(uint32_t(rhs.height())));
+      node.room = gen.next() & 1 ? lhs : rhs;
+    }
+  }
+};
+
+DungeonGenerator *create_bsp_generator(size_t min_leaf_size, size_t min_room_size)
+{
+  return new BspDungeonGenerator(min_leaf_size, min_room_size);
+}
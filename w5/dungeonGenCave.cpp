@@ -0,0 +1,135 @@
+#include "dungeonGen.h"
+#include "dungeonUtils.h"
+#include <algorithm>
+#include <vector>
+#include "rng.h"
+
+// One bit per cell, 1 is a wall. Rows are padded to whole words, padding and everything
+// outside of the map reads as wall, so caves never leak through the border.
+struct BitGrid
+{
+  size_t width = 0;
+  size_t height = 0;
+  size_t rowWords = 0;
+  std::vector<uint64_t> bits;
+
+  BitGrid(size_t w, size_t h) : width(w), height(h), rowWords((w + 63) / 64), bits(rowWords * h, ~0ull) {}
+
+  uint64_t *row(size_t y) { return bits.data() + y * rowWords; }
+  const uint64_t *row(size_t y) const { return bits.data() + y * rowWords; }
+
+  uint64_t paddingMask() const { return width % 64 == 0 ? 0ull : ~0ull << (width % 64); }
+};
+
+// bits set with probability ~p (in 1/256 steps): walk the binary digits of p from the lowest,
+// OR-ing a fresh random word in for ones and AND-ing it in for zeroes
+static uint64_t random_bits(rng::Xoshiro256 &gen, float p)
+{
+  const uint32_t threshold = uint32_t(std::clamp(p, 0.f, 1.f) * 256.f);
+  if (threshold >= 256)
+    return ~0ull;
+  uint64_t res = 0;
+  for (int bit = 0; bit < 8; ++bit)
+    res = (threshold >> bit) & 1 ? res | gen.next() : res & gen.next();
+  return res;
+}
+
+// sum of three one bit numbers per lane: sum bit and carry bit
+static void full_add(uint64_t a, uint64_t b, uint64_t c, uint64_t &sum, uint64_t &carry)
+{
+  const uint64_t ab = a ^ b;
+  sum = ab ^ c;
+  carry = (a & b) | (c & ab);
+}
+
+// Classic 4-5 rule: a cell is a wall if at least 5 cells of its 3x3 neighbourhood are walls.
+// Neighbour counts are done bit-sliced, so every logic op handles 64 cells at once,
+// inner loop is plain word arithmetic which compilers are free to vectorize further.
+static void cave_step(const BitGrid &src, BitGrid &dst)
+{
+  const size_t words = src.rowWords;
+  const uint64_t padding = src.paddingMask();
+  std::vector<uint64_t> wall(words, ~0ull);
+  std::vector<uint64_t> sums[3], carries[3];
+  for (std::vector<uint64_t> &v : sums)
+    v.resize(words);
+  for (std::vector<uint64_t> &v : carries)
+    v.resize(words);
+
+  // horizontal 3 cell sums of a row as 2 bit numbers
+  auto rowSums = [&](const uint64_t *row, std::vector<uint64_t> &sum, std::vector<uint64_t> &carry)
+  {
+    for (size_t i = 0; i < words; ++i)
+    {
+      const uint64_t prev = i > 0 ? row[i - 1] : ~0ull;
+      const uint64_t next = i + 1 < words ? row[i + 1] : ~0ull;
+      const uint64_t west = (row[i] << 1) | (prev >> 63);
+      const uint64_t east = (row[i] >> 1) | (next << 63);
+      full_add(west, row[i], east, sum[i], carry[i]);
+    }
+  };
+
+  for (size_t y = 0; y < src.height; ++y)
+  {
+    rowSums(y > 0 ? src.row(y - 1) : wall.data(), sums[0], carries[0]);
+    rowSums(src.row(y), sums[1], carries[1]);
+    rowSums(y + 1 < src.height ? src.row(y + 1) : wall.data(), sums[2], carries[2]);
+    uint64_t *out = dst.row(y);
+    for (size_t i = 0; i < words; ++i)
+    {
+      // ones + 2 * (three carries + carry of ones) = count in 0..9 as bits b1, b2, b4, b8
+      uint64_t b1, onesCarry, twos, twosCarry;
+      full_add(sums[0][i], sums[1][i], sums[2][i], b1, onesCarry);
+      full_add(carries[0][i], carries[1][i], carries[2][i], twos, twosCarry);
+      const uint64_t b2 = twos ^ onesCarry;
+      const uint64_t fours = twos & onesCarry;
+      const uint64_t b4 = twosCarry ^ fours;
+      const uint64_t b8 = twosCarry & fours;
+      out[i] = b8 | (b4 & (b2 | b1));
+    }
+    out[words - 1] |= padding;
+  }
+}
+
+class CaveDungeonGenerator : public DungeonGenerator
+{
+  float wallChance;
+  size_t iterations;
+public:
+  CaveDungeonGenerator(float wall_chance, size_t iter) : wallChance(wall_chance), iterations(iter) {}
+
+  void generate(char *tiles, size_t w, size_t h) const override
+  {
+    rng::Xoshiro256 gen((uint64_t(rng::next()) << 32) | rng::next());
+    BitGrid grid(w, h);
+    BitGrid next(w, h);
+    for (size_t y = 0; y < h; ++y)
+    {
+      uint64_t *row = grid.row(y);
+      for (size_t i = 0; i < grid.rowWords; ++i)
+        row[i] = random_bits(gen, wallChance);
+      row[grid.rowWords - 1] |= grid.paddingMask();
+    }
+    for (size_t iter = 0; iter < iterations; ++iter)
+    {
+      cave_step(grid, next);
+      std::swap(grid, next);
+    }
+
+    for (size_t y = 0; y < h; ++y)
+    {
+      const uint64_t *row = grid.row(y);
+      for (size_t x = 0; x < w; ++x)
+      {
+        const bool border = x == 0 || y == 0 || x + 1 == w || y + 1 == h;
+        const bool isWall = border || ((row[x / 64] >> (x % 64)) & 1);
+        tiles[y * w + x] = isWall ? dungeon::wall : dungeon::floor;
+      }
+    }
+  }
+};
+
+DungeonGenerator *create_cave_generator(float wall_chance, size_t iterations)
+{
+  return new CaveDungeonGenerator(wall_chance, iterations);
+}
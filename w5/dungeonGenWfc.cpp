@@ -0,0 +1,235 @@
+#include "dungeonGen.h"
+#include "dungeonUtils.h"
+#include <algorithm>
+#include <bit>
+#include <cstring> // memset
+#include <queue>
+#include <string>
+#include <vector>
+#include "rng.h"
+
+// 3x3 tiles laid out with a stride of 2, so neighbours share their edge row or column
+// and adjacency rules fall out of edges being equal. Rotations are added automatically.
+struct WfcTile
+{
+  char cells[3][3];
+  float weight;
+};
+
+struct WfcPrototype
+{
+  const char *pattern; // 9 chars, rows top to bottom
+  float weight;
+};
+
+static const WfcPrototype wfc_prototypes[] = {
+  {"#########", 6.f}, // solid rock
+  {"#.##.##.#", 2.f}, // corridor
+  {"#.##..###", 1.f}, // corridor turn
+  {"#.#...###", 0.5f}, // corridor fork
+  {"#.#...#.#", 0.2f}, // crossing
+  {"#.##.####", 0.2f}, // dead end
+  {".........", 4.f}, // room
+  {"###......", 1.f}, // room wall
+  {"####..#..", 1.f}, // room corner
+  {"#.#......", 0.3f}, // door
+};
+
+constexpr size_t wfc_dirs = 4; // right, down, left, up
+constexpr int wfc_dx[wfc_dirs] = {1, 0, -1, 0};
+constexpr int wfc_dy[wfc_dirs] = {0, 1, 0, -1};
+
+// edge as a string of 3 chars read left to right or top to bottom
+static std::string tile_edge(const WfcTile &tile, size_t dir)
+{
+  std::string res;
+  for (size_t i = 0; i < 3; ++i)
+    res += dir == 0 ? tile.cells[i][2] : dir == 1 ? tile.cells[2][i] : dir == 2 ? tile.cells[i][0] : tile.cells[0][i];
+  return res;
+}
+
+static std::vector<WfcTile> build_wfc_tiles()
+{
+  std::vector<WfcTile> tiles;
+  for (const WfcPrototype &proto : wfc_prototypes)
+  {
+    WfcTile tile;
+    tile.weight = proto.weight;
+    for (size_t i = 0; i < 9; ++i)
+      tile.cells[i / 3][i % 3] = proto.pattern[i];
+    for (int rot = 0; rot < 4; ++rot)
+    {
+      const bool duplicate = std::any_of(tiles.begin(), tiles.end(),
+          [&](const WfcTile &t) { return memcmp(t.cells, tile.cells, sizeof(tile.cells)) == 0; });
+      if (!duplicate)
+        tiles.push_back(tile);
+      WfcTile rotated = tile;
+      for (size_t y = 0; y < 3; ++y)
+        for (size_t x = 0; x < 3; ++x)
+          rotated.cells[y][x] = tile.cells[2 - x][y];
+      tile = rotated;
+    }
+  }
+  return tiles;
+}
+
+using WfcMask = uint64_t; // tile set has to fit into 64 tiles
+
+struct WfcEntry
+{
+  int entropy;
+  uint32_t noise; // random tie break
+  size_t cell;
+
+  bool operator>(const WfcEntry &rhs) const
+  {
+    return entropy > rhs.entropy || (entropy == rhs.entropy && noise > rhs.noise);
+  }
+};
+
+class WfcDungeonGenerator : public DungeonGenerator
+{
+  std::vector<WfcTile> tiles;
+  WfcMask compatible[wfc_dirs][64] = {}; // tiles allowed next to a tile in a direction
+  WfcMask borderTiles[wfc_dirs] = {}; // tiles with a solid edge in a direction
+  static constexpr size_t max_attempts = 8;
+
+  WfcMask allowedNext(WfcMask mask, size_t dir) const
+  {
+    WfcMask res = 0;
+    for (; mask != 0; mask &= mask - 1)
+      res |= compatible[dir][std::countr_zero(mask)];
+    return res;
+  }
+
+  // returns false on contradiction
+  bool propagate(std::vector<WfcMask> &cells, size_t gw, size_t gh, std::vector<size_t> &stack,
+                 std::priority_queue<WfcEntry, std::vector<WfcEntry>, std::greater<WfcEntry>> &open,
+                 rng::Xoshiro256 &gen) const
+  {
+    while (!stack.empty())
+    {
+      const size_t cell = stack.back();
+      stack.pop_back();
+      const int x = int(cell % gw);
+      const int y = int(cell / gw);
+      for (size_t dir = 0; dir < wfc_dirs; ++dir)
+      {
+        const int nx = x + wfc_dx[dir];
+        const int ny = y + wfc_dy[dir];
+        if (nx < 0 || ny < 0 || nx >= int(gw) || ny >= int(gh))
+          continue;
+        const size_t nei = size_t(ny) * gw + size_t(nx);
+        const WfcMask reduced = cells[nei] & allowedNext(cells[cell], dir);
+        if (reduced == cells[nei])
+          continue;
+        if (reduced == 0)
+          return false;
+        cells[nei] = reduced;
+        stack.push_back(nei);
+        open.push({std::popcount(reduced), uint32_t(gen.next()), nei});
+      }
+    }
+    return true;
+  }
+
+  bool collapse(std::vector<WfcMask> &cells, size_t gw, size_t gh, rng::Xoshiro256 &gen) const
+  {
+    const WfcMask all = tiles.size() == 64 ? ~0ull : (1ull << tiles.size()) - 1;
+    std::priority_queue<WfcEntry, std::vector<WfcEntry>, std::greater<WfcEntry>> open;
+    std::vector<size_t> stack;
+    cells.assign(gw * gh, all);
+    // outer edges of the grid are the map border, it has to stay rock
+    for (size_t y = 0; y < gh; ++y)
+      for (size_t x = 0; x < gw; ++x)
+      {
+        WfcMask &cell = cells[y * gw + x];
+        if (x + 1 == gw)
+          cell &= borderTiles[0];
+        if (y + 1 == gh)
+          cell &= borderTiles[1];
+        if (x == 0)
+          cell &= borderTiles[2];
+        if (y == 0)
+          cell &= borderTiles[3];
+        stack.push_back(y * gw + x);
+        open.push({std::popcount(cell), uint32_t(gen.next()), y * gw + x});
+      }
+    if (!propagate(cells, gw, gh, stack, open, gen))
+      return false;
+
+    // lowest entropy first, stale entries are skipped by comparing entropy with the current one
+    while (!open.empty())
+    {
+      const WfcEntry top = open.top();
+      open.pop();
+      const WfcMask mask = cells[top.cell];
+      if (std::popcount(mask) != top.entropy || top.entropy <= 1)
+        continue;
+      float total = 0.f;
+      for (WfcMask m = mask; m != 0; m &= m - 1)
+        total += tiles[size_t(std::countr_zero(m))].weight;
+      float pick = float(gen.next() >> 40) / float(1ull << 24) * total;
+      size_t chosen = size_t(std::countr_zero(mask));
+      for (WfcMask m = mask; m != 0; m &= m - 1)
+      {
+        chosen = size_t(std::countr_zero(m));
+        pick -= tiles[chosen].weight;
+        if (pick <= 0.f)
+          break;
+      }
+      cells[top.cell] = 1ull << chosen;
+      stack.push_back(top.cell);
+      if (!propagate(cells, gw, gh, stack, open, gen))
+        return false;
+    }
+    return true;
+  }
+
+public:
+  WfcDungeonGenerator() : tiles(build_wfc_tiles())
+  {
+    for (size_t a = 0; a < tiles.size(); ++a)
+      for (size_t dir = 0; dir < wfc_dirs; ++dir)
+      {
+        const std::string edge = tile_edge(tiles[a], dir);
+        if (edge == "###")
+          borderTiles[dir] |= 1ull << a;
+        for (size_t b = 0; b < tiles.size(); ++b)
+          if (edge == tile_edge(tiles[b], (dir + 2) % wfc_dirs))
+            compatible[dir][a] |= 1ull << b;
+      }
+  }
+
+  void generate(char *out, size_t w, size_t h) const override
+  {
+    memset(out, dungeon::wall, w * h);
+    if (w < 3 || h < 3)
+      return;
+    const size_t gw = (w - 1) / 2;
+    const size_t gh = (h - 1) / 2;
+    rng::Xoshiro256 gen((uint64_t(rng::next()) << 32) | rng::next());
+    std::vector<WfcMask> cells;
+    // contradictions are rare with this tile set, restart a few times and then keep the last attempt,
+    // cells left without options stay rock
+    for (size_t attempt = 0; attempt < max_attempts && !collapse(cells, gw, gh, gen); ++attempt)
+      ;
+    for (size_t gy = 0; gy < gh; ++gy)
+      for (size_t gx = 0; gx < gw; ++gx)
+      {
+        const WfcMask mask = cells[gy * gw + gx];
+        if (std::popcount(mask) != 1)
+          continue;
+        const WfcTile &tile = tiles[size_t(std::countr_zero(mask))];
+        for (size_t y = 0; y < 3; ++y)
+          for (size_t x = 0; x < 3; ++x)
+            if (tile.cells[y][x] == '.')
+              out[(gy * 2 + y) * w + gx * 2 + x] = dungeon::floor;
+      }
+  }
+};
+
+DungeonGenerator *create_wfc_generator()
+{
+  return new WfcDungeonGenerator();
+}
@@ -0,0 +1,75 @@
+#include "dungeonRegions.h"
+#include "dungeonUtils.h"
+
+// union-find over provisional run labels
+static uint32_t find_root(std::vector<uint32_t> &parent, uint32_t label)
+{
+  while (parent[label] != label)
+  {
+    parent[label] = parent[parent[label]]; // path halving
+    label = parent[label];
+  }
+  return label;
+}
+
+static void unite(std::vector<uint32_t> &parent, uint32_t a, uint32_t b)
+{
+  a = find_root(parent, a);
+  b = find_root(parent, b);
+  // smaller label wins, so final ids follow scan order
+  if (a < b)
+    parent[b] = a;
+  else if (b < a)
+    parent[a] = b;
+}
+
+void dungeon::label_regions(const char *tiles, size_t w, size_t h, Regions &regions)
+{
+  std::vector<uint32_t> &label = regions.tileRegion;
+  label.assign(w * h, no_region);
+  std::vector<uint32_t> parent;
+
+  // first pass: every horizontal floor run gets a label, merged with runs touching it from the row above
+  for (size_t y = 0; y < h; ++y)
+  {
+    const char *row = tiles + y * w;
+    uint32_t *rowLabel = label.data() + y * w;
+    const uint32_t *prevLabel = y > 0 ? rowLabel - w : nullptr;
+    for (size_t x = 0; x < w; ++x)
+    {
+      if (row[x] != dungeon::floor)
+        continue;
+      if (x > 0 && row[x - 1] == dungeon::floor)
+        rowLabel[x] = rowLabel[x - 1];
+      else
+      {
+        rowLabel[x] = uint32_t(parent.size());
+        parent.push_back(rowLabel[x]);
+      }
+      if (prevLabel && prevLabel[x] != no_region)
+        unite(parent, rowLabel[x], prevLabel[x]);
+    }
+  }
+
+  // second pass: flatten to dense ids and count sizes
+  std::vector<uint32_t> denseId(parent.size(), no_region);
+  regions.regionSize.clear();
+  for (uint32_t &l : label)
+  {
+    if (l == no_region)
+      continue;
+    const uint32_t root = find_root(parent, l);
+    if (denseId[root] == no_region)
+    {
+      denseId[root] = uint32_t(regions.regionSize.size());
+      regions.regionSize.push_back(0);
+    }
+    l = denseId[root];
+    regions.regionSize[l]++;
+  }
+
+  regions.largest = no_region;
+  for (uint32_t r = 0; r < regions.regionSize.size(); ++r)
+    if (regions.largest == no_region || regions.regionSize[r] > regions.regionSize[regions.largest])
+      regions.largest = r;
+}
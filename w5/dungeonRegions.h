@@ -0,0 +1,20 @@
+#pragma once
+#include <cstddef> // size_t
+#include <cstdint>
+#include <vector>
+
+namespace dungeon
+{
+  constexpr uint32_t no_region = ~0u; // walls
+
+  // 4-connected floor components, ids are dense and numbered in scan order
+  struct Regions
+  {
+    std::vector<uint32_t> tileRegion; // per tile, no_region for walls
+    std::vector<size_t> regionSize; // floor tiles in each region
+    uint32_t largest = no_region;
+  };
+
+  // two scanline passes with union-find over floor runs, linear in the number of tiles
+  void label_regions(const char *tiles, size_t w, size_t h, Regions &regions);
+};
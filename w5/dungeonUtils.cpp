@@ -1,5 +1,5 @@
 #include "dungeonUtils.h"
-#include "raylib.h"
+#include "rng.h"
 
 Position dungeon::find_walkable_tile(flecs::world &ecs)
 {
@@ -8,13 +8,17 @@ Position dungeon::find_walkable_tile(flecs::world &ecs)
   Position res{0, 0};
   dungeonDataQuery.each([&](const DungeonData &dd)
   {
-    // prebuild all walkable and get one of them
+    if (dd.regions.largest == dungeon::no_region) // no floor at all, walls are no_region too
+      return;
+    // prebuild all walkable and get one of them, pockets cut off from the largest region are skipped
     std::vector<Position> posList;
     for (size_t y = 0; y < dd.height; ++y)
       for (size_t x = 0; x < dd.width; ++x)
-        if (dd.tiles[y * dd.width + x] == dungeon::floor)
+        if (dd.regions.tileRegion[y * dd.width + x] == dd.regions.largest)
           posList.push_back(Position{int(x), int(y)});
-    size_t rndIdx = size_t(GetRandomValue(0, int(posList.size()) - 1));
+    if (posList.empty())
+      return;
+    size_t rndIdx = size_t(rng::rand_int(0, int(posList.size()) - 1));
     res = posList[rndIdx];
   });
   return res;
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include "dungeonRegions.h"
 
 // TODO: make a lot of seprate files
 struct Position;
@@ -49,6 +52,9 @@ inline bool operator==(const MovePos &lhs, const MovePos &rhs) { return lhs.x ==
 inline bool operator==(const MovePos &lhs, const Position &rhs) { return lhs.x == rhs.x && lhs.y == rhs.y; }
 inline bool operator!=(const Position &lhs, const Position &rhs) { return !(lhs == rhs); };
 
+// unique key of a tile for hashing, works for tiles outside of the dungeon too
+inline int64_t tile_key(int x, int y) { return int64_t(uint64_t(uint32_t(y)) << 32 | uint32_t(x)); }
+
 
 struct PatrolPos
 {
@@ -101,12 +107,13 @@ struct PowerupAmount
   float amount = 0.f;
 };
 
-struct PlayerInput
+// keyboard controlled, see set_player_action
+struct PlayerInput {};
+
+// drives the player instead of the keyboard in headless runs
+struct AutoPlayer
 {
-  bool left = false;
-  bool right = false;
-  bool up = false;
-  bool down = false;
+  Position lastPos{-1, -1};
 };
 
 struct Symbol
@@ -130,19 +137,48 @@ struct TurnCounter
   int count = 0;
 };
 
-struct ActionLog
+enum LogEventType : uint8_t
 {
-  std::vector<std::string> log;
-  size_t capacity = 5;
+  LOG_HEAL_SELF,
+  LOG_DAMAGE,
+  LOG_DEATH
+};
+
+struct LogEvent
+{
+  int turn = 0;
+  LogEventType type = LOG_DAMAGE;
+  uint64_t source = 0; // entity ids
+  uint64_t target = 0;
+  float amount = 0.f;
 };
 
-struct BackgroundTile {};
+// Ring of the last few events, the oldest one is overwritten. Events are plain records,
+// text is only made when the log is shown (see format_log_event).
+struct ActionLog
+{
+  static constexpr size_t capacity = 5;
+  std::array<LogEvent, capacity> events;
+  size_t next = 0; // slot written next
+  size_t count = 0;
+
+  void push(const LogEvent &ev)
+  {
+    events[next] = ev;
+    next = (next + 1) % capacity;
+    count = count < capacity ? count + 1 : capacity;
+  }
+
+  // 0 is the oldest of the stored events
+  const LogEvent &at(size_t idx) const { return events[(next + capacity - count + idx) % capacity]; }
+};
 
 struct DungeonData
 {
   std::vector<char> tiles; // for pathfinding
   size_t width;
   size_t height;
+  dungeon::Regions regions; // connected floor areas, spawns only go to the largest one
 };
 
 struct DijkstraMapData
@@ -1,33 +1,36 @@
 #include "goapAction.h"
 
-goap::Action goap::create_action(const char *name, const WorldDesc &desc, float cost)
+goap::Action goap::create_action(float cost)
 {
   Action res;
-  res.name = name;
   res.cost = cost;
-  for (size_t i = 0; i < desc.size(); ++i)
-  {
-    res.precondition.push_back(-1);
-    res.effect.push_back(-1);
-    res.setBitset.push_back(true);
-  }
   return res;
 }
 
+static uint64_t lane_bits(size_t idx, int8_t val)
+{
+  return uint64_t(uint8_t(val)) << (idx % 8 * 8);
+}
+
 void goap::set_action_precond(Action &act, const WorldDesc &desc, const char *st_name, int8_t val)
 {
   auto itf = desc.find(st_name);
   if (itf == desc.end())
     return; // TODO: Assert
-  act.precondition[itf->second] = val;
+  act.precondition.set(itf->second, val);
+  act.preconditionMask = act.precondition.careMask();
 }
 
 void goap::set_action_effect(Action &act, const WorldDesc &desc, const char *st_name, int8_t val)
 {
   auto itf = desc.find(st_name);
-  if (itf == desc.end())
+  if (itf == desc.end() || val < 0)
     return; // TODO: Assert
-  act.effect[itf->second] = val;
+  const size_t word = itf->second / 8;
+  const uint64_t laneMask = lane_bits(itf->second, -1);
+  act.setEffect[word] = (act.setEffect[word] & ~laneMask) | lane_bits(itf->second, val);
+  act.setMask[word] |= laneMask;
+  act.addEffect[word] &= ~laneMask;
 }
 
 void goap::set_additive_action_effect(Action &act, const WorldDesc &desc, const char *st_name, int8_t val)
@@ -35,7 +38,68 @@ void goap::set_additive_action_effect(Action &act, const WorldDesc &desc, const
   auto itf = desc.find(st_name);
   if (itf == desc.end())
     return; // TODO: Assert
-  act.effect[itf->second] = val;
-  act.setBitset[itf->second] = false;
+  const size_t word = itf->second / 8;
+  const uint64_t laneMask = lane_bits(itf->second, -1);
+  act.addEffect[word] = (act.addEffect[word] & ~laneMask) | lane_bits(itf->second, val);
+  act.setEffect[word] &= ~laneMask;
+  act.setMask[word] &= ~laneMask;
+}
+
+size_t goap::add_action(ActionTable &actions, const Action &act)
+{
+  actions.precondition.push_back(act.precondition);
+  actions.preconditionMask.push_back(act.preconditionMask);
+  actions.setEffect.push_back(act.setEffect);
+  actions.setMask.push_back(act.setMask);
+  actions.addEffect.push_back(act.addEffect);
+  actions.cost.push_back(act.cost);
+  return actions.size() - 1;
+}
+
+bool goap::is_action_valid(const ActionTable &actions, size_t act, const WorldState &from)
+{
+  return from.matches(actions.precondition[act].words, actions.preconditionMask[act]);
+}
+
+goap::WorldState goap::apply_action_effect(const ActionTable &actions, size_t act, const WorldState &from)
+{
+  const StateWords &setMask = actions.setMask[act];
+  const StateWords &setEffect = actions.setEffect[act];
+  const StateWords &addEffect = actions.addEffect[act];
+  WorldState res;
+  for (size_t i = 0; i < world_state_words; ++i)
+    res.words[i] = lanes_add((from.words[i] & ~setMask[i]) | setEffect[i], addEffect[i]);
+  return res;
 }
 
+bool goap::regress_action_effect(const ActionTable &actions, size_t act, const WorldState &constraints, WorldState &res)
+{
+  const StateWords &precondition = actions.precondition[act].words;
+  const StateWords &preconditionMask = actions.preconditionMask[act];
+  const StateWords &setEffect = actions.setEffect[act];
+  const StateWords &actSetMask = actions.setMask[act];
+  const StateWords &addEffect = actions.addEffect[act];
+  bool relevant = false;
+  for (size_t i = 0; i < world_state_words; ++i)
+  {
+    const uint64_t care = lanes_set_mask(constraints.words[i]);
+    const uint64_t addMask = lanes_nonzero_mask(addEffect[i]) & care;
+    const uint64_t setMask = actSetMask[i] & care;
+    if ((setEffect[i] ^ constraints.words[i]) & setMask)
+      return false; // sets a variable to something else than we need
+    relevant |= (setMask | addMask) != 0;
+
+    // set variables don't have to hold before, additive ones must hold minus the delta
+    const uint64_t beforeAdd = lanes_add(constraints.words[i], lanes_neg(addEffect[i])) & addMask;
+    if (beforeAdd & lane_high_bits)
+      return false; // would need a negative value
+    uint64_t word = (constraints.words[i] & ~(setMask | addMask)) | beforeAdd | setMask;
+
+    const uint64_t wordCare = care & ~setMask;
+    if ((word ^ precondition[i]) & wordCare & preconditionMask[i])
+      return false; // precondition contradicts constraints
+    word = (word & ~preconditionMask[i]) | (precondition[i] & preconditionMask[i]);
+    res.words[i] = word;
+  }
+  return relevant;
+}
@@ -1,25 +1,47 @@
 #pragma once
 #include "goapWorldState.h"
-#include <string>
+#include <vector>
 
 namespace goap
 {
 
+  // single action description, used to build up actions before they go into the planner's table
   struct Action
   {
-    std::string name = "";
-
     WorldState precondition;
-    WorldState effect;
+    StateWords preconditionMask = {}; // 0xff lanes for variables checked by precondition
 
-    std::vector<bool> setBitset; // if effect sets world state, or is it additive (true - sets, false - additive)
+    StateWords setEffect = {}; // values for variables which effect sets
+    StateWords setMask = {}; // 0xff lanes for variables which effect sets
+    StateWords addEffect = {}; // per lane deltas for additive effects, 0 if untouched
 
     float cost = 1.f;
   };
 
-  Action create_action(const char *name, const WorldDesc &desc, float cost);
+  // Structure of arrays with every action field in its own contiguous array indexed by action id,
+  // search loops only touch the fields they need. Names live in the planner as debug info.
+  struct ActionTable
+  {
+    std::vector<WorldState> precondition;
+    std::vector<StateWords> preconditionMask;
+    std::vector<StateWords> setEffect;
+    std::vector<StateWords> setMask;
+    std::vector<StateWords> addEffect;
+    std::vector<float> cost;
+
+    size_t size() const { return cost.size(); }
+  };
+
+  Action create_action(float cost);
   void set_action_precond(Action &act, const WorldDesc &desc, const char *st_name, int8_t val);
   void set_action_effect(Action &act, const WorldDesc &desc, const char *st_name, int8_t val);
   void set_additive_action_effect(Action &act, const WorldDesc &desc, const char *st_name, int8_t val);
-};
 
+  size_t add_action(ActionTable &actions, const Action &act);
+
+  bool is_action_valid(const ActionTable &actions, size_t act, const WorldState &from);
+  WorldState apply_action_effect(const ActionTable &actions, size_t act, const WorldState &from);
+  // regression through the action: state constraints that must hold before the action so that
+  // constraints hold after it, false if the action doesn't help or contradicts them
+  bool regress_action_effect(const ActionTable &actions, size_t act, const WorldState &constraints, WorldState &res);
+};
@@ -0,0 +1,120 @@
+#include "goapActionIndex.h"
+#include <algorithm>
+
+void goap::build_precondition_index(PreconditionIndex &index, const ActionTable &actions)
+{
+  index = PreconditionIndex{};
+  for (size_t act = 0; act < actions.size(); ++act)
+    add_to_precondition_index(index, actions, act);
+}
+
+// copies every live block into a fresh array with the new stride, which also drops abandoned blocks
+static void relayout_buckets(goap::PreconditionIndex &index, size_t stride)
+{
+  std::vector<uint64_t> buckets;
+  for (size_t i = 0; i < index.testedVars.size(); ++i)
+  {
+    const size_t offset = buckets.size();
+    buckets.resize(offset + (index.numValues[i] + 1) * stride, 0);
+    for (size_t bucket = 0; bucket <= index.numValues[i]; ++bucket)
+      std::copy_n(&index.buckets[index.bucketOffsets[i] + bucket * index.stride], index.maskWords,
+                  &buckets[offset + bucket * stride]);
+    index.bucketOffsets[i] = offset;
+  }
+  index.buckets = std::move(buckets);
+  index.stride = stride;
+}
+
+// sets bits of actions [0, count) in the bucket, used for actions that don't test a new variable
+static void set_all_before(uint64_t *bucket, size_t count)
+{
+  for (size_t w = 0; w < count / 64; ++w)
+    bucket[w] = ~0ull;
+  if (count % 64 != 0)
+    bucket[count / 64] |= (1ull << (count % 64)) - 1;
+}
+
+// makes val fall into a value bucket of the tested var, the new value buckets get the "don't care" actions
+static void extend_value_range(goap::PreconditionIndex &index, size_t i, int val)
+{
+  const int oldMin = index.minValues[i];
+  const size_t oldNum = index.numValues[i];
+  const int newMin = std::min(oldMin, val);
+  const size_t newNum = size_t(std::max(oldMin + int(oldNum) - 1, val) - newMin + 1);
+  const size_t oldOffset = index.bucketOffsets[i];
+  const size_t offset = index.buckets.size();
+  index.buckets.resize(offset + (newNum + 1) * index.stride, 0);
+  const uint64_t *dontCare = &index.buckets[oldOffset + oldNum * index.stride];
+  for (size_t bucket = 0; bucket <= newNum; ++bucket)
+  {
+    const int oldBucket = bucket == newNum ? int(oldNum) : int(bucket) + newMin - oldMin;
+    const bool existed = oldBucket >= 0 && oldBucket <= int(oldNum);
+    const uint64_t *src = existed ? &index.buckets[oldOffset + size_t(oldBucket) * index.stride] : dontCare;
+    std::copy_n(src, index.maskWords, &index.buckets[offset + bucket * index.stride]);
+  }
+  index.bucketOffsets[i] = offset;
+  index.minValues[i] = newMin;
+  index.numValues[i] = newNum;
+}
+
+void goap::add_to_precondition_index(PreconditionIndex &index, const ActionTable &actions, size_t act)
+{
+  index.numActions = act + 1;
+  const size_t maskWords = (index.numActions + 63) / 64;
+  if (maskWords > index.stride)
+    relayout_buckets(index, std::max(index.stride * 2, size_t(1)));
+  index.maskWords = maskWords;
+
+  // -1 (0xff) is "don't care", the same as in the packed state, any other value is tested
+  const WorldState &precondition = actions.precondition[act];
+  for (size_t var = 0; var < max_world_vars; ++var)
+  {
+    const int8_t val = precondition.get(var);
+    if (val == -1)
+      continue;
+    auto it = std::find(index.testedVars.begin(), index.testedVars.end(), var);
+    if (it == index.testedVars.end())
+    {
+      // one value bucket and the "don't care" one, both accept every earlier action
+      const size_t offset = index.buckets.size();
+      index.buckets.resize(offset + 2 * index.stride, 0);
+      set_all_before(&index.buckets[offset], act);
+      set_all_before(&index.buckets[offset + index.stride], act);
+      index.testedVars.push_back(var);
+      index.bucketOffsets.push_back(offset);
+      index.minValues.push_back(val);
+      index.numValues.push_back(1);
+      continue;
+    }
+    const size_t i = size_t(it - index.testedVars.begin());
+    if (val < index.minValues[i] || val >= index.minValues[i] + int(index.numValues[i]))
+      extend_value_range(index, i, val);
+  }
+
+  const uint64_t bit = 1ull << (act % 64);
+  for (size_t i = 0; i < index.testedVars.size(); ++i)
+  {
+    const int8_t val = precondition.get(index.testedVars[i]);
+    for (size_t bucket = 0; bucket <= index.numValues[i]; ++bucket)
+      if (val == -1 || int(val) - index.minValues[i] == int(bucket))
+        index.buckets[index.bucketOffsets[i] + bucket * index.stride + act / 64] |= bit;
+  }
+}
+
+void goap::find_applicable_actions(const PreconditionIndex &index, const WorldState &from, ActionMask &res)
+{
+  res.assign(index.maskWords, ~0ull);
+  if (index.numActions % 64 != 0)
+    res.back() = (1ull << (index.numActions % 64)) - 1;
+
+  for (size_t i = 0; i < index.testedVars.size(); ++i)
+  {
+    const int8_t val = from.get(index.testedVars[i]);
+    // unknown (-1) and untested values fall into the last bucket with "don't care" actions only
+    const int rel = int(val) - index.minValues[i];
+    const size_t bucket = val != -1 && rel >= 0 && size_t(rel) < index.numValues[i] ? size_t(rel) : index.numValues[i];
+    const uint64_t *mask = &index.buckets[index.bucketOffsets[i] + bucket * index.stride];
+    for (size_t w = 0; w < index.maskWords; ++w)
+      res[w] &= mask[w];
+  }
+}
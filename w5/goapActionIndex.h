@@ -0,0 +1,40 @@
+#pragma once
+#include <vector>
+#include <bit>
+#include "goapWorldState.h"
+#include "goapAction.h"
+
+namespace goap
+{
+  // one bit per action
+  using ActionMask = std::vector<uint64_t>;
+
+  // For every variable some action has a precondition on, keeps per value bitmasks of actions
+  // that accept this value. Applicable actions are an AND of one bucket per tested variable.
+  // Actions are inserted one by one, so building a planner action by action stays linear.
+  struct PreconditionIndex
+  {
+    size_t numActions = 0;
+    size_t maskWords = 0; // words in use per bucket
+    size_t stride = 0; // words allocated per bucket, grows by doubling
+
+    std::vector<size_t> testedVars;
+    std::vector<size_t> bucketOffsets; // per tested var, offset of its first bucket in buckets
+    std::vector<int> minValues; // per tested var, value of the first bucket
+    std::vector<size_t> numValues; // per tested var, last bucket (numValues) is for values no action tests
+    std::vector<uint64_t> buckets; // blocks of vars whose value range grew are left behind until the next regrow
+  };
+
+  void build_precondition_index(PreconditionIndex &index, const ActionTable &actions);
+  // act has to be the next action after the ones already in the index
+  void add_to_precondition_index(PreconditionIndex &index, const ActionTable &actions, size_t act);
+  void find_applicable_actions(const PreconditionIndex &index, const WorldState &from, ActionMask &res);
+
+  template<typename Callable>
+  inline void for_each_action(const ActionMask &mask, Callable c)
+  {
+    for (size_t i = 0; i < mask.size(); ++i)
+      for (uint64_t bits = mask[i]; bits != 0; bits &= bits - 1)
+        c(i * 64 + size_t(std::countr_zero(bits)));
+  }
+};
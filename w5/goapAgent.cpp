@@ -0,0 +1,42 @@
+#include "goapAgent.h"
+
+// Looked up per call: a static query would stay bound to the first world that used it,
+// and the simulation and render worlds are separate.
+static GoapPlanningService *get_planning_service(const flecs::world &ecs)
+{
+  flecs::entity holder = ecs.lookup("world");
+  return holder.is_valid() ? holder.get_mut<GoapPlanningService>() : nullptr;
+}
+
+void request_goap_plan(flecs::entity e, std::shared_ptr<const goap::Planner> planner,
+                       const goap::WorldState &from, const goap::WorldState &to)
+{
+  GoapPlanningService *service = get_planning_service(e.world());
+  if (!service)
+    return;
+  if (!service->planner)
+    service->planner = std::make_shared<goap::AsyncPlanner>();
+  const uint64_t requestId = service->planner->submit(std::move(planner), from, to, e.id());
+  e.set(GoapPlanPending{requestId});
+}
+
+void deliver_goap_plans(flecs::world &ecs)
+{
+  const GoapPlanningService *service = get_planning_service(ecs);
+  if (!service || !service->planner)
+    return;
+
+  std::vector<goap::AsyncPlanResult> results;
+  service->planner->collect(results);
+  for (goap::AsyncPlanResult &res : results)
+  {
+    if (!ecs.is_alive(flecs::entity_t(res.tag)))
+      continue;
+    flecs::entity e = ecs.entity(flecs::entity_t(res.tag));
+    const GoapPlanPending *pending = e.get<GoapPlanPending>();
+    if (!pending || pending->requestId != res.requestId)
+      continue; // cancelled or re-requested since then
+    e.remove<GoapPlanPending>();
+    e.set(GoapPlan{std::move(res.plan), res.cost, res.found});
+  }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <flecs.h>
+#include <memory>
+#include "goapAsyncPlanner.h"
+
+// singleton-like component, lives on the "world" entity
+struct GoapPlanningService
+{
+  std::shared_ptr<goap::AsyncPlanner> planner; // null until the first request, so its workers only start when needed
+};
+
+// set while a plan is being computed, stale results are dropped by request id
+struct GoapPlanPending
+{
+  uint64_t requestId = 0;
+};
+
+struct GoapPlan
+{
+  std::vector<goap::PlanStep> steps;
+  float cost = 0.f;
+  bool found = false;
+};
+
+// planner is shared with the worker thread and must not be modified afterwards
+void request_goap_plan(flecs::entity e, std::shared_ptr<const goap::Planner> planner,
+                       const goap::WorldState &from, const goap::WorldState &to);
+// moves finished plans onto their entities, call from the main thread only
+void deliver_goap_plans(flecs::world &ecs);
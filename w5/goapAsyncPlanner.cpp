@@ -0,0 +1,44 @@
+#include "goapAsyncPlanner.h"
+
+goap::AsyncPlanner::AsyncPlanner(size_t num_threads) : pool(num_threads)
+{
+}
+
+uint64_t goap::AsyncPlanner::submit(std::shared_ptr<const Planner> planner, const WorldState &from, const WorldState &to,
+                                    uint64_t tag, SearchMode mode)
+{
+  const uint64_t requestId = nextRequestId++;
+  numInFlight++;
+  pool.submit([this, planner = std::move(planner), from, to, tag, requestId, mode]()
+  {
+    AsyncPlanResult res;
+    res.tag = tag;
+    res.requestId = requestId;
+    PlanSearch search(*planner, from, to, mode);
+    res.found = search.step(PlanBudget{}) == PLAN_FOUND;
+    if (res.found)
+    {
+      res.plan = search.plan();
+      res.cost = search.cost();
+    }
+    {
+      std::lock_guard<std::mutex> lock(resultsMutex);
+      finished.push_back(std::move(res));
+    }
+    numInFlight--;
+  });
+  return requestId;
+}
+
+void goap::AsyncPlanner::collect(std::vector<AsyncPlanResult> &res)
+{
+  std::lock_guard<std::mutex> lock(resultsMutex);
+  for (AsyncPlanResult &r : finished)
+    res.push_back(std::move(r));
+  finished.clear();
+}
+
+void goap::AsyncPlanner::waitAll()
+{
+  pool.waitIdle();
+}
@@ -0,0 +1,44 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "goapPlanner.h"
+#include "goapPlanSearch.h"
+#include "threadPool.h"
+
+namespace goap
+{
+  struct AsyncPlanResult
+  {
+    uint64_t tag = 0; // whatever the requester passed, e.g. an entity id
+    uint64_t requestId = 0;
+    std::vector<PlanStep> plan;
+    float cost = 0.f;
+    bool found = false;
+  };
+
+  // Plans on worker threads. Planners are shared immutable data while requests are in flight,
+  // finished results are buffered until the owner collects them at a sync point.
+  class AsyncPlanner
+  {
+  public:
+    explicit AsyncPlanner(size_t num_threads = 0);
+
+    // returns request id, it's also stored in the result
+    uint64_t submit(std::shared_ptr<const Planner> planner, const WorldState &from, const WorldState &to, uint64_t tag,
+                    SearchMode mode = SEARCH_FORWARD);
+    // appends all finished results to res
+    void collect(std::vector<AsyncPlanResult> &res);
+    void waitAll();
+
+    size_t inFlight() const { return numInFlight.load(); }
+
+  private:
+    std::mutex resultsMutex;
+    std::vector<AsyncPlanResult> finished;
+    std::atomic<size_t> numInFlight = 0;
+    uint64_t nextRequestId = 1;
+    ThreadPool pool; // last, so workers are joined before results are destroyed
+  };
+};
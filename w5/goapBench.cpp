@@ -0,0 +1,248 @@
+#include "goapBench.h"
+#include "goapDomains.h"
+#include "goapPlanScheduler.h"
+#include "goapAsyncPlanner.h"
+#include "rng.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+using DomainCreator = goap::Domain(*)(size_t);
+
+const char *mode_name(goap::SearchMode mode)
+{
+  return mode == goap::SEARCH_BACKWARD ? "backward" : mode == goap::SEARCH_BIDIRECTIONAL ? "bidir" : "forward";
+}
+
+const char *heuristic_name(goap::HeuristicKind kind)
+{
+  switch (kind)
+  {
+    case goap::HEURISTIC_SUM_ABS: return "sum_abs";
+    case goap::HEURISTIC_UNSATISFIED: return "unsatisfied";
+    case goap::HEURISTIC_MAX_PER_ACTION: return "max_per_action";
+    case goap::HEURISTIC_NONE: return "none";
+  }
+  return "";
+}
+
+static void bench_domain(const char *name, DomainCreator create, size_t extra_actions, goap::SearchMode mode,
+                         int num_runs)
+{
+  goap::Domain dom = create(extra_actions);
+  goap::PlanStats stats;
+  std::vector<goap::PlanStep> plan;
+  float cost = 0.f;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_runs; ++i)
+  {
+    plan.clear();
+    cost = goap::make_plan(dom.planner, dom.start, dom.goal, plan, mode, &stats);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const double usPerPlan = std::chrono::duration<double, std::micro>(end - start).count() / num_runs;
+
+  printf("%8s | %8s | %7zu | %9zu | %9zu | %4zu | %5.1f | %10.1f\n", name, mode_name(mode), dom.planner.actions.size(),
+         stats.nodesExpanded, stats.nodesGenerated, plan.size(), double(cost), usPerPlan);
+}
+
+static goap::WorldState random_enemy_start(const goap::Planner &pl, rng::Xoshiro256 &gen)
+{
+  return goap::produce_planner_worldstate(pl,
+      {{"enemy_vis", int(gen.below(2))},
+       {"enemy_alive", 1},
+       {"have_melee", int(gen.below(2))},
+       {"have_ranged", int(gen.below(2))},
+       {"enemy_dist", int(gen.below(3))},
+       {"health_state", gen.below(4) == 0 ? Injured : Healthy}});
+}
+
+static void bench_plan_cache(size_t capacity, int num_requests)
+{
+  goap::Domain dom = goap::create_enemy_domain();
+  goap::set_plan_cache_capacity(dom.planner, capacity);
+  rng::Xoshiro256 gen(1337);
+  std::vector<goap::PlanStep> plan;
+
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_requests; ++i)
+    goap::make_cached_plan(dom.planner, random_enemy_start(dom.planner, gen), dom.goal, plan);
+  const auto end = std::chrono::steady_clock::now();
+  const double usPerPlan = std::chrono::duration<double, std::micro>(end - start).count() / num_requests;
+
+  const goap::PlanCacheStats &st = dom.planner.planCache.stats;
+  printf("%8zu | %6zu | %6zu | %9zu | %6.1f%% | %7.2f\n", capacity, st.hits, st.misses, st.evictions,
+         100.0 * double(st.hits) / double(num_requests), usPerPlan);
+}
+
+static void bench_plan_repair(int num_requests)
+{
+  goap::Domain dom = goap::create_enemy_domain();
+  rng::Xoshiro256 gen(1337);
+  std::vector<goap::PlanStep> plan;
+  goap::make_cached_plan(dom.planner, dom.start, dom.goal, plan);
+  for (int i = 0; i < num_requests; ++i)
+    goap::repair_plan(dom.planner, random_enemy_start(dom.planner, gen), dom.goal, plan);
+  const goap::PlanCacheStats &st = dom.planner.planCache.stats;
+  printf("repair: %d requests, %zu repaired, %zu steps kept, %zu cache hits, %zu misses\n", num_requests, st.repairs,
+         st.repairedSteps, st.hits, st.misses);
+}
+
+static void bench_plan_scheduler(size_t num_agents, const goap::PlanBudget &budget)
+{
+  goap::Domain dom = goap::create_looter_domain(16);
+  goap::PlanScheduler scheduler;
+  std::vector<goap::PlanScheduler::Handle> handles;
+  for (size_t i = 0; i < num_agents; ++i)
+    handles.push_back(scheduler.submit(dom.planner, dom.start, dom.goal));
+
+  std::vector<double> frameUs;
+  double totalUs = 0.0;
+  while (scheduler.pendingCount() > 0)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    scheduler.update(budget);
+    frameUs.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count());
+    totalUs += frameUs.back();
+  }
+  // max includes the odd frame the OS took the thread away in, p99 shows what the scheduler itself keeps to
+  const size_t numFrames = frameUs.size();
+  std::sort(frameUs.begin(), frameUs.end());
+  size_t numFound = 0;
+  std::vector<goap::PlanStep> plan;
+  float cost = 0.f;
+  for (goap::PlanScheduler::Handle handle : handles)
+    if (scheduler.takeResult(handle, plan, cost) && !plan.empty())
+      numFound++;
+  const int expansions = budget.expansions == size_t(-1) ? -1 : int(budget.expansions); // -1 - unlimited
+  printf("%6zu | %10d | %9.0f | %6zu | %5zu | %11.1f | %11.1f | %11.1f\n", num_agents, expansions,
+         double(budget.microseconds), numFrames, numFound, totalUs / double(numFrames), frameUs[numFrames * 99 / 100],
+         frameUs.back());
+}
+
+struct HeuristicConfig
+{
+  const char *name;
+  goap::HeuristicKind kind;
+  float weight;
+};
+
+// optimal cost comes from uniform cost search, so suboptimality is exact
+static void bench_heuristic(const char *name, DomainCreator create, size_t extra_actions, const HeuristicConfig &conf,
+                            int num_runs)
+{
+  goap::Domain dom = create(extra_actions);
+  std::vector<goap::PlanStep> plan;
+  goap::set_planner_heuristic(dom.planner, goap::HEURISTIC_NONE);
+  const float bestCost = goap::make_plan(dom.planner, dom.start, dom.goal, plan);
+  goap::set_planner_heuristic(dom.planner, conf.kind, conf.weight);
+
+  goap::PlanStats stats;
+  float cost = 0.f;
+  const auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < num_runs; ++i)
+  {
+    plan.clear();
+    cost = goap::make_plan(dom.planner, dom.start, dom.goal, plan, goap::SEARCH_FORWARD, &stats);
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const double usPerPlan = std::chrono::duration<double, std::micro>(end - start).count() / num_runs;
+  const double subopt = bestCost > 0.f ? 100.0 * double(cost - bestCost) / double(bestCost) : 0.0;
+
+  printf("%8s | %7zu | %11s | %6.1f | %9zu | %5.1f | %5.1f | %6.1f%% | %10.1f\n", name, dom.planner.actions.size(),
+         conf.name, double(conf.weight), stats.nodesExpanded, double(cost), double(bestCost), subopt, usPerPlan);
+}
+
+// stress test: thousands of requests in flight, results checked against synchronous planning
+static void bench_async_planner(size_t num_requests, size_t num_threads)
+{
+  const std::shared_ptr<const goap::Planner> planner =
+    std::make_shared<goap::Planner>(goap::create_enemy_domain(16).planner);
+  const goap::WorldState goal = goap::create_enemy_domain().goal;
+  rng::Xoshiro256 gen(1337);
+  std::vector<goap::WorldState> starts;
+  for (size_t i = 0; i < num_requests; ++i)
+    starts.push_back(random_enemy_start(*planner, gen));
+
+  const auto start = std::chrono::steady_clock::now();
+  std::vector<goap::AsyncPlanResult> results;
+  size_t numPolls = 0;
+  {
+    goap::AsyncPlanner async(num_threads);
+    for (size_t i = 0; i < num_requests; ++i)
+      async.submit(planner, starts[i], goal, i);
+    // poll like a game loop would, collecting whatever is ready
+    while (results.size() < num_requests)
+    {
+      async.collect(results);
+      numPolls++;
+      std::this_thread::yield();
+    }
+  }
+  const double totalUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+  size_t numMismatches = 0;
+  for (const goap::AsyncPlanResult &res : results)
+  {
+    std::vector<goap::PlanStep> plan;
+    const float cost = goap::make_plan(*planner, starts[res.tag], goal, plan);
+    if (res.found != !plan.empty() || (res.found && cost != res.cost))
+      numMismatches++;
+  }
+  printf("%7zu | %7zu | %10.1f | %8.2f | %7zu | %10zu\n", num_threads, num_requests, totalUs / 1000.0,
+         totalUs / double(num_requests), numPolls, numMismatches);
+}
+
+void bench_goap_planners()
+{
+  printf("%8s | %8s | %7s | %9s | %9s | %4s | %5s | %10s\n", "domain", "mode", "actions", "expanded", "generated",
+         "len", "cost", "us/plan");
+  const size_t extraActions[] = {0, 16, 64, 256, 1024};
+  const goap::SearchMode modes[] = {goap::SEARCH_FORWARD, goap::SEARCH_BACKWARD, goap::SEARCH_BIDIRECTIONAL};
+  for (size_t extra : extraActions)
+    for (goap::SearchMode mode : modes)
+    {
+      const int numRuns = extra >= 256 ? 10 : 100;
+      bench_domain("enemy", goap::create_enemy_domain, extra, mode, numRuns);
+      bench_domain("looter", goap::create_looter_domain, extra, mode, numRuns);
+    }
+
+  printf("\n%8s | %7s | %11s | %6s | %9s | %5s | %5s | %7s | %10s\n", "domain", "actions", "heuristic", "weight",
+         "expanded", "cost", "best", "subopt", "us/plan");
+  const HeuristicConfig heuristics[] = {
+    {"none", goap::HEURISTIC_NONE, 1.f},
+    {"sum_abs", goap::HEURISTIC_SUM_ABS, 1.f},
+    {"unsatisfied", goap::HEURISTIC_UNSATISFIED, 1.f},
+    {"max_per_act", goap::HEURISTIC_MAX_PER_ACTION, 1.f},
+    {"max_per_act", goap::HEURISTIC_MAX_PER_ACTION, 1.5f},
+    {"max_per_act", goap::HEURISTIC_MAX_PER_ACTION, 3.f},
+    {"unsatisfied", goap::HEURISTIC_UNSATISFIED, 2.f}};
+  const size_t heuristicExtraActions[] = {0, 64};
+  for (size_t extra : heuristicExtraActions)
+    for (const HeuristicConfig &conf : heuristics)
+    {
+      bench_heuristic("enemy", goap::create_enemy_domain, extra, conf, 100);
+      bench_heuristic("looter", goap::create_looter_domain, extra, conf, extra > 0 ? 5 : 20);
+    }
+
+  printf("\n%8s | %6s | %6s | %9s | %7s | %7s\n", "capacity", "hits", "misses", "evictions", "hitrate", "us/plan");
+  const size_t cacheCapacities[] = {0, 4, 16, 64};
+  for (size_t capacity : cacheCapacities)
+    bench_plan_cache(capacity, 10000);
+  bench_plan_repair(1000);
+
+  printf("\n%6s | %10s | %9s | %6s | %5s | %11s | %11s | %11s\n", "agents", "exp/frame", "us/frame", "frames", "found",
+         "avg us/frm", "p99 us/frm", "max us/frm");
+  bench_plan_scheduler(64, goap::PlanBudget{1000, 0.f});
+  bench_plan_scheduler(64, goap::PlanBudget{4000, 0.f});
+  bench_plan_scheduler(64, goap::PlanBudget{size_t(-1), 2000.f});
+  bench_plan_scheduler(256, goap::PlanBudget{size_t(-1), 2000.f});
+
+  printf("\n%7s | %7s | %10s | %8s | %7s | %10s\n", "threads", "plans", "total ms", "us/plan", "polls",
+         "mismatches");
+  const size_t threadCounts[] = {1, 2, 4, 0};
+  for (size_t numThreads : threadCounts)
+    bench_async_planner(5000, numThreads);
+}
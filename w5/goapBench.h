@@ -0,0 +1,9 @@
+#pragma once
+#include "goapPlanner.h"
+
+// Shared by `hw5 --bench-goap` and `goap_bench --suite`.
+// runs looter/enemy planners with growing action sets and plan cache sizes, prints timings
+void bench_goap_planners();
+
+const char *mode_name(goap::SearchMode mode);
+const char *heuristic_name(goap::HeuristicKind kind);
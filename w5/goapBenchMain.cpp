@@ -0,0 +1,254 @@
+// Headless GOAP benchmark, built as a separate goap_bench target without raylib and flecs.
+// Prints a table by default or JSON with --json, so results can be diffed across commits.
+#include "goapBench.h"
+#include "goapDomains.h"
+#include "goapPlanSearch.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+struct BenchCase
+{
+  std::string name;
+  goap::Domain domain;
+};
+
+struct BenchResult
+{
+  std::string name;
+  const char *mode = "";
+  const char *heuristic = "";
+  float weight = 1.f;
+  size_t vars = 0;
+  size_t actions = 0;
+  int runs = 0;
+  bool found = false;
+  float cost = 0.f;
+  size_t length = 0;
+  goap::PlanStats stats;
+  double usMean = 0.0;
+  double usMin = 0.0;
+};
+
+struct BenchOptions
+{
+  bool json = false;
+  bool suite = false; // the planner, heuristic, cache, scheduler and async tables of bench_goap_planners
+  int runs = 10;
+  goap::SearchMode mode = goap::SEARCH_FORWARD;
+  goap::HeuristicKind heuristic = goap::HEURISTIC_SUM_ABS;
+  float weight = 1.f;
+  bool synthetic = false; // run only the synthetic domain described below instead of the suite
+  goap::SyntheticDomainDesc desc;
+  std::vector<std::string> domainFiles; // run only these (and the synthetic one if given)
+};
+
+static BenchResult run_case(BenchCase &bc, const BenchOptions &opt)
+{
+  goap::Planner &planner = bc.domain.planner;
+  goap::set_planner_heuristic(planner, opt.heuristic, opt.weight);
+
+  BenchResult res;
+  res.name = bc.name;
+  res.mode = mode_name(opt.mode);
+  res.heuristic = heuristic_name(opt.heuristic);
+  res.weight = opt.weight;
+  res.vars = planner.varNames.size();
+  res.actions = planner.actions.size();
+  res.runs = opt.runs;
+  res.usMin = 1e30;
+  double usTotal = 0.0;
+  for (int i = 0; i < opt.runs; ++i)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    goap::PlanSearch search(planner, bc.domain.start, bc.domain.goal, opt.mode);
+    search.step(goap::PlanBudget{});
+    const double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    usTotal += us;
+    res.usMin = std::min(res.usMin, us);
+    res.found = search.status() == goap::PLAN_FOUND;
+    res.cost = search.cost();
+    res.length = search.plan().size();
+    res.stats = search.stats();
+  }
+  res.usMean = usTotal / std::max(opt.runs, 1);
+  return res;
+}
+
+static void print_table(const std::vector<BenchResult> &results)
+{
+  printf("%-28s | %8s | %14s | %4s | %7s | %5s | %6s | %4s | %9s | %9s | %9s | %10s | %10s\n", "domain", "mode",
+         "heuristic", "vars", "actions", "found", "cost", "len", "expanded", "generated", "peak KB", "mean us",
+         "min us");
+  for (const BenchResult &r : results)
+    printf("%-28s | %8s | %14s | %4zu | %7zu | %5s | %6.1f | %4zu | %9zu | %9zu | %9.1f | %10.1f | %10.1f\n",
+           r.name.c_str(), r.mode, r.heuristic, r.vars, r.actions, r.found ? "yes" : "no", double(r.cost), r.length,
+           r.stats.nodesExpanded, r.stats.nodesGenerated, double(r.stats.peakSearchBytes) / 1024.0, r.usMean, r.usMin);
+}
+
+static void print_json(const std::vector<BenchResult> &results)
+{
+  printf("[\n");
+  for (size_t i = 0; i < results.size(); ++i)
+  {
+    const BenchResult &r = results[i];
+    printf("  {\"domain\": \"%s\", \"mode\": \"%s\", \"heuristic\": \"%s\", \"weight\": %g, \"vars\": %zu, "
+           "\"actions\": %zu, \"runs\": %d, \"found\": %s, \"cost\": %g, \"length\": %zu, \"nodes_expanded\": %zu, "
+           "\"nodes_generated\": %zu, \"peak_search_bytes\": %zu, \"mean_us\": %.2f, \"min_us\": %.2f}%s\n",
+           r.name.c_str(), r.mode, r.heuristic, double(r.weight), r.vars, r.actions, r.runs,
+           r.found ? "true" : "false", double(r.cost), r.length, r.stats.nodesExpanded, r.stats.nodesGenerated,
+           r.stats.peakSearchBytes, r.usMean, r.usMin, i + 1 < results.size() ? "," : "");
+  }
+  printf("]\n");
+}
+
+static std::string synthetic_name(const goap::SyntheticDomainDesc &desc)
+{
+  return "synth_v" + std::to_string(desc.numVars) + "_a" + std::to_string(desc.numActions) + "_p" +
+         std::to_string(desc.precondsPerAction) + "_d" + std::to_string(desc.goalDepth);
+}
+
+static void add_synthetic(std::vector<BenchCase> &cases, const goap::SyntheticDomainDesc &desc)
+{
+  cases.push_back({synthetic_name(desc), goap::create_synthetic_domain(desc)});
+}
+
+static std::vector<BenchCase> default_suite(uint32_t seed)
+{
+  std::vector<BenchCase> cases;
+  cases.push_back({"enemy", goap::create_enemy_domain()});
+  cases.push_back({"looter", goap::create_looter_domain()});
+  cases.push_back({"enemy_busy64", goap::create_enemy_domain(64)});
+  cases.push_back({"looter_busy16", goap::create_looter_domain(16)});
+
+  goap::SyntheticDomainDesc desc;
+  desc.seed = seed;
+  desc.goalDepth = 20;
+  desc.goalVars = 8;
+  add_synthetic(cases, desc);
+  desc.numVars = 32;
+  desc.numActions = 256;
+  desc.goalDepth = 32;
+  desc.goalVars = 12;
+  add_synthetic(cases, desc);
+  desc.numVars = 64;
+  desc.numActions = 1024;
+  desc.precondsPerAction = 3;
+  desc.goalDepth = 24;
+  desc.goalVars = 8;
+  add_synthetic(cases, desc);
+  return cases;
+}
+
+static void print_usage()
+{
+  printf("usage: goap_bench [--json] [--runs N] [--mode forward|backward|bidir]\n"
+         "                  [--heuristic sum_abs|unsatisfied|max_per_action|none] [--weight W] [--seed N]\n"
+         "                  [--vars N --values N --actions N --preconds N --effects N --depth N --goal-vars N]\n"
+         "                  [--domain FILE]...\n"
+         "       goap_bench --suite\n"
+         "any of the synthetic domain options or --domain runs only those domains instead of the default suite,\n"
+         "see goap::load_domain for the domain file format\n"
+         "--suite prints the same tables as hw5 --bench-goap\n");
+}
+
+static bool parse_args(int argc, const char **argv, BenchOptions &opt)
+{
+  for (int i = 1; i < argc; ++i)
+  {
+    const char *arg = argv[i];
+    if (strcmp(arg, "--json") == 0)
+    {
+      opt.json = true;
+      continue;
+    }
+    if (strcmp(arg, "--suite") == 0)
+    {
+      opt.suite = true;
+      continue;
+    }
+    if (i + 1 >= argc)
+      return false;
+    const char *val = argv[++i];
+    const size_t num = size_t(strtoull(val, nullptr, 10));
+    if (strcmp(arg, "--runs") == 0)
+      opt.runs = std::max(1, atoi(val));
+    else if (strcmp(arg, "--mode") == 0)
+      opt.mode = strcmp(val, "backward") == 0 ? goap::SEARCH_BACKWARD :
+                 strcmp(val, "bidir") == 0 ? goap::SEARCH_BIDIRECTIONAL : goap::SEARCH_FORWARD;
+    else if (strcmp(arg, "--heuristic") == 0)
+      opt.heuristic = strcmp(val, "unsatisfied") == 0 ? goap::HEURISTIC_UNSATISFIED :
+                      strcmp(val, "max_per_action") == 0 ? goap::HEURISTIC_MAX_PER_ACTION :
+                      strcmp(val, "none") == 0 ? goap::HEURISTIC_NONE : goap::HEURISTIC_SUM_ABS;
+    else if (strcmp(arg, "--weight") == 0)
+      opt.weight = float(atof(val));
+    else if (strcmp(arg, "--seed") == 0)
+      opt.desc.seed = uint32_t(num);
+    else if (strcmp(arg, "--domain") == 0)
+      opt.domainFiles.push_back(val);
+    else
+    {
+      opt.synthetic = true;
+      if (strcmp(arg, "--vars") == 0)
+        opt.desc.numVars = num;
+      else if (strcmp(arg, "--values") == 0)
+        opt.desc.numValues = num;
+      else if (strcmp(arg, "--actions") == 0)
+        opt.desc.numActions = num;
+      else if (strcmp(arg, "--preconds") == 0)
+        opt.desc.precondsPerAction = num;
+      else if (strcmp(arg, "--effects") == 0)
+        opt.desc.effectsPerAction = num;
+      else if (strcmp(arg, "--depth") == 0)
+        opt.desc.goalDepth = num;
+      else if (strcmp(arg, "--goal-vars") == 0)
+        opt.desc.goalVars = num;
+      else
+        return false;
+    }
+  }
+  return true;
+}
+
+int main(int argc, const char **argv)
+{
+  BenchOptions opt;
+  if (!parse_args(argc, argv, opt))
+  {
+    print_usage();
+    return 1;
+  }
+
+  if (opt.suite)
+  {
+    bench_goap_planners();
+    return 0;
+  }
+
+  std::vector<BenchCase> cases;
+  for (const std::string &path : opt.domainFiles)
+  {
+    BenchCase bc{path, {}};
+    if (!goap::load_domain(path.c_str(), bc.domain))
+      return 1;
+    cases.push_back(std::move(bc));
+  }
+  if (opt.synthetic)
+    add_synthetic(cases, opt.desc);
+  else if (cases.empty())
+    cases = default_suite(opt.desc.seed);
+
+  std::vector<BenchResult> results;
+  for (BenchCase &bc : cases)
+    results.push_back(run_case(bc, opt));
+
+  if (opt.json)
+    print_json(results);
+  else
+    print_table(results);
+  return 0;
+}
@@ -0,0 +1,332 @@
+#include "goapDomains.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+static void add_busywork_actions(goap::Planner &pl, size_t extra_actions)
+{
+  for (size_t i = 0; i < extra_actions; ++i)
+  {
+    const std::string name = "busywork_" + std::to_string(i);
+    goap::add_action_to_planner(pl, name.c_str(), 5,
+        {},
+        {{"busywork", int(i % 120) + 1}},
+        {});
+  }
+}
+
+goap::Domain goap::create_enemy_domain(size_t extra_actions)
+{
+  Domain dom{create_planner(), {}, {}};
+  Planner &pl = dom.planner;
+
+  add_states_to_planner(pl,
+      {"enemy_vis",
+       "enemy_alive",
+       "have_melee",
+       "have_ranged",
+       "enemy_dist",
+       "health_state"});
+  if (extra_actions > 0)
+    add_states_to_planner(pl, {"busywork"});
+
+  add_action_to_planner(pl, "wander", 1,
+      {{"health_state", Healthy}},
+      {{"enemy_vis", 1}},
+      {});
+
+  add_action_to_planner(pl, "approach_enemy", 1,
+      {{"health_state", Healthy}},
+      {},
+      {{"enemy_dist", -1}});
+
+  add_action_to_planner(pl, "flee_enemy", 1,
+      {{"health_state", Healthy}},
+      {},
+      {{"enemy_dist", +1}});
+
+  add_action_to_planner(pl, "find_melee", 1,
+      {{"have_melee", 0}, {"health_state", Healthy}},
+      {{"have_melee", 1}},
+      {});
+
+  add_action_to_planner(pl, "find_ranged", 1,
+      {{"have_ranged", 0}, {"health_state", Healthy}},
+      {{"have_ranged", 1}},
+      {});
+
+  add_action_to_planner(pl, "patch_up", 1,
+      {{"health_state", Injured}},
+      {},
+      {{"health_state", +1}});
+
+  add_action_to_planner(pl, "attack_enemy", 1,
+      {{"enemy_vis", 1}, {"enemy_alive", 1}, {"have_melee", 1}, {"enemy_dist", DistMelee}, {"health_state", Healthy}},
+      {{"enemy_alive", 0}},
+      {{"health_state", -1}});
+
+  add_action_to_planner(pl, "shoot_enemy", 1,
+      {{"enemy_vis", 1}, {"enemy_alive", 1}, {"have_ranged", 1}, {"enemy_dist", DistRanged}, {"health_state", Healthy}},
+      {{"enemy_alive", 0}},
+      {});
+
+  add_busywork_actions(pl, extra_actions);
+
+  dom.start = produce_planner_worldstate(pl,
+      {{"enemy_vis", 0},
+       {"enemy_alive", 1},
+       {"have_melee", 0},
+       {"have_ranged", 0},
+       {"enemy_dist", DistFar},
+       {"health_state", Healthy},
+       {"busywork", 0}});
+
+  dom.goal = produce_planner_worldstate(pl,
+      {{"enemy_alive", 0}, {"health_state", Healthy}});
+  return dom;
+}
+
+goap::Domain goap::create_looter_domain(size_t extra_actions)
+{
+  Domain dom{create_planner(), {}, {}};
+  Planner &pl = dom.planner;
+
+  add_states_to_planner(pl,
+      {"enemy_vis",
+       "loot_vis",
+       "num_loot",
+       "have_melee",
+       "have_ranged",
+       "enemy_dist",
+       "health_state",
+       "escaped"});
+  if (extra_actions > 0)
+    add_states_to_planner(pl, {"busywork"});
+
+  add_action_to_planner(pl, "open_room", 1,
+      {{"health_state", Healthy}},
+      {{"enemy_vis", 1}, {"loot_vis", 1}/*, {"enemy_dist", 2}*/},
+      {});
+
+  add_action_to_planner(pl, "loot", 1,
+      {{"health_state", Healthy}, {"loot_vis", 1}, {"enemy_vis", 0}},
+      {{"loot_vis", 0}},
+      {{"num_loot", +1}});
+
+  add_action_to_planner(pl, "approach_enemy", 1,
+      {{"health_state", Healthy}},
+      {},
+      {{"enemy_dist", -1}});
+
+  add_action_to_planner(pl, "flee_enemy", 1,
+      {{"health_state", Healthy}},
+      {},
+      {{"enemy_dist", +1}});
+
+  add_action_to_planner(pl, "find_melee", 1,
+      {{"have_melee", 0}, {"health_state", Healthy}},
+      {{"have_melee", 1}},
+      {});
+
+  add_action_to_planner(pl, "find_ranged", 1,
+      {{"have_ranged", 0}, {"health_state", Healthy}},
+      {{"have_ranged", 1}},
+      {});
+
+  add_action_to_planner(pl, "patch_up", 1,
+      {{"health_state", Injured}},
+      {},
+      {{"health_state", +1}});
+
+  add_action_to_planner(pl, "attack_enemy", 1,
+      {{"enemy_vis", 1}, {"have_melee", 1}, {"enemy_dist", DistMelee}, {"health_state", Healthy}},
+      {{"enemy_vis", 0}},
+      {{"health_state", -1}});
+
+  add_action_to_planner(pl, "shoot_enemy", 1,
+      {{"enemy_vis", 1}, {"have_ranged", 1}, {"enemy_dist", DistRanged}, {"health_state", Healthy}},
+      {{"enemy_vis", 0}},
+      {{"health_state", -1}});
+
+  add_action_to_planner(pl, "escape", 1,
+      {{"health_state", Healthy}, {"num_loot", 5}},
+      {{"escaped", 1}},
+      {});
+
+  add_busywork_actions(pl, extra_actions);
+
+  dom.start = produce_planner_worldstate(pl,
+      {{"enemy_vis", 0},
+       {"loot_vis", 0},
+       {"num_loot", 0},
+       {"have_melee", 1},
+       {"have_ranged", 0},
+       {"enemy_dist", DistFar},
+       {"health_state", Healthy},
+       {"escaped", 0},
+       {"busywork", 0}});
+
+  dom.goal = produce_planner_worldstate(pl,
+      {{"num_loot", 5}, {"escaped", 1}, {"health_state", Healthy}});
+  return dom;
+}
+
+// picks count distinct variables
+static std::vector<size_t> random_vars(std::mt19937 &rng, size_t num_vars, size_t count)
+{
+  std::vector<size_t> vars(num_vars);
+  for (size_t i = 0; i < num_vars; ++i)
+    vars[i] = i;
+  std::shuffle(vars.begin(), vars.end(), rng);
+  vars.resize(std::min(count, num_vars));
+  return vars;
+}
+
+goap::Domain goap::create_synthetic_domain(const SyntheticDomainDesc &desc)
+{
+  Domain dom{create_planner(), {}, {}};
+  Planner &pl = dom.planner;
+  std::mt19937 rng(desc.seed);
+  const size_t numVars = std::min(desc.numVars, max_world_vars);
+  const size_t numValues = std::clamp(desc.numValues, size_t(2), size_t(127));
+  std::uniform_int_distribution<int> valueDist(0, int(numValues) - 1);
+  std::uniform_real_distribution<float> costDist(1.f, std::max(desc.maxActionCost, 1.f));
+
+  std::vector<std::string> varNames;
+  for (size_t i = 0; i < numVars; ++i)
+    varNames.push_back("v" + std::to_string(i));
+  add_states_to_planner(pl, varNames);
+
+  for (size_t i = 0; i < desc.numActions; ++i)
+  {
+    Precond precond;
+    for (size_t var : random_vars(rng, numVars, desc.precondsPerAction))
+      precond.emplace_back(varNames[var].c_str(), valueDist(rng));
+    Effect effect;
+    for (size_t var : random_vars(rng, numVars, desc.effectsPerAction))
+      effect.emplace_back(varNames[var].c_str(), valueDist(rng));
+    const std::string name = "a" + std::to_string(i);
+    add_action_to_planner(pl, name.c_str(), costDist(rng), precond, effect, {});
+  }
+
+  for (size_t i = 0; i < numVars; ++i)
+    dom.start.set(i, int8_t(valueDist(rng)));
+
+  // walk randomly and use whatever it ends up with as the goal
+  WorldState cur = dom.start;
+  ActionMask applicable;
+  std::vector<size_t> candidates;
+  for (size_t step = 0; step < desc.goalDepth; ++step)
+  {
+    find_valid_state_transitions(pl, cur, applicable);
+    candidates.clear();
+    for_each_action(applicable, [&](size_t act) { candidates.push_back(act); });
+    if (candidates.empty())
+      break;
+    cur = apply_action(pl, candidates[rng() % candidates.size()], cur);
+  }
+  // prefer variables the walk has changed, so the goal isn't trivially satisfied
+  std::vector<size_t> goalVars;
+  for (size_t var : random_vars(rng, numVars, numVars))
+    if (cur.get(var) != dom.start.get(var))
+      goalVars.push_back(var);
+  for (size_t var : random_vars(rng, numVars, numVars))
+    if (cur.get(var) == dom.start.get(var))
+      goalVars.push_back(var);
+  goalVars.resize(std::min(desc.goalVars, goalVars.size()));
+  for (size_t var : goalVars)
+    dom.goal.set(var, cur.get(var));
+  return dom;
+}
+
+// "var=value" pairs until the next keyword, names point into tokens which outlive the result
+static bool parse_states(const goap::Planner &pl, std::vector<std::string> &tokens, size_t &idx,
+                         goap::WorldStateList &res)
+{
+  for (; idx < tokens.size(); ++idx)
+  {
+    std::string &tok = tokens[idx];
+    const size_t eq = tok.find('=');
+    if (eq == std::string::npos)
+      return true; // next keyword
+    tok[eq] = '\0';
+    if (pl.wdesc.find(tok.c_str()) == pl.wdesc.end())
+      return false;
+    res.emplace_back(tok.c_str(), atoi(tok.c_str() + eq + 1));
+  }
+  return true;
+}
+
+static bool parse_domain_line(goap::Domain &dom, std::vector<std::string> &tokens)
+{
+  goap::Planner &pl = dom.planner;
+  const std::string &cmd = tokens[0];
+  size_t idx = 1;
+  if (cmd == "vars")
+  {
+    if (!pl.actions.cost.empty())
+      return false;
+    return goap::add_states_to_planner(pl, std::vector<std::string>(tokens.begin() + 1, tokens.end()));
+  }
+  if (cmd == "start" || cmd == "goal")
+  {
+    goap::WorldStateList states;
+    if (!parse_states(pl, tokens, idx, states) || idx != tokens.size())
+      return false;
+    goap::WorldState &ws = cmd == "start" ? dom.start : dom.goal;
+    for (const goap::StateDesc &st : states)
+      ws.set(pl.wdesc.at(st.first), int8_t(st.second));
+    return true;
+  }
+  if (cmd != "action" || tokens.size() < 3)
+    return false;
+  char *costEnd = nullptr;
+  const float cost = strtof(tokens[2].c_str(), &costEnd);
+  if (*costEnd != '\0')
+    return false;
+  goap::Precond precond;
+  goap::Effect effect;
+  goap::Effect additive;
+  for (idx = 3; idx < tokens.size();)
+  {
+    const std::string &section = tokens[idx++];
+    goap::WorldStateList *states = section == "pre" ? &precond : section == "set" ? &effect :
+                                   section == "add" ? &additive : nullptr;
+    if (!states || !parse_states(pl, tokens, idx, *states))
+      return false;
+  }
+  goap::add_action_to_planner(pl, tokens[1].c_str(), cost, precond, effect, additive);
+  return true;
+}
+
+bool goap::load_domain(const char *path, Domain &dom)
+{
+  std::ifstream file(path);
+  if (!file)
+  {
+    printf("can't open domain %s\n", path);
+    return false;
+  }
+  dom = Domain{create_planner(), {}, {}};
+  std::string line;
+  std::vector<std::string> tokens;
+  for (int lineNo = 1; std::getline(file, line); ++lineNo)
+  {
+    line = line.substr(0, line.find('#'));
+    std::istringstream words(line);
+    tokens.clear();
+    for (std::string tok; words >> tok;)
+      tokens.push_back(tok);
+    if (tokens.empty())
+      continue;
+    if (!parse_domain_line(dom, tokens))
+    {
+      printf("%s:%d: can't parse '%s'\n", path, lineNo, line.c_str());
+      return false;
+    }
+  }
+  return true;
+}
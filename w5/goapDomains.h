@@ -0,0 +1,55 @@
+#pragma once
+#include "goapPlanner.h"
+#include <cstdint>
+
+enum EnemyDist
+{
+  DistMelee = 0,
+  DistRanged,
+  DistFar
+};
+
+enum HealthState
+{
+  Dead = 0,
+  Injured,
+  Healthy
+};
+
+namespace goap
+{
+  struct Domain
+  {
+    Planner planner;
+    WorldState start;
+    WorldState goal;
+  };
+
+  // extra_actions adds that many useless but always applicable actions, to stress the planner
+  Domain create_enemy_domain(size_t extra_actions = 0);
+  Domain create_looter_domain(size_t extra_actions = 0);
+
+  struct SyntheticDomainDesc
+  {
+    size_t numVars = 16;
+    size_t numValues = 4;
+    size_t numActions = 64;
+    size_t precondsPerAction = 2; // fewer preconditions make more actions applicable, i.e. higher branching
+    size_t effectsPerAction = 2;
+    size_t goalDepth = 12; // goal is taken from a random walk of this length, so it's always reachable
+    size_t goalVars = 4;
+    float maxActionCost = 1.f; // costs are uniform in [1, maxActionCost]
+    uint32_t seed = 1;
+  };
+
+  // random domain of a given size, same desc always produces the same domain
+  Domain create_synthetic_domain(const SyntheticDomainDesc &desc);
+
+  // Reads a domain from a text file, one statement per line, '#' starts a comment:
+  //   vars <name>...                  all variables, before the first action
+  //   action <name> <cost> [pre <var>=<value>...] [set <var>=<value>...] [add <var>=<delta>...]
+  //   start <var>=<value>...
+  //   goal <var>=<value>...
+  // Prints the offending line and returns false on errors.
+  bool load_domain(const char *path, Domain &dom);
+};
@@ -0,0 +1,98 @@
+#include "goapHeuristic.h"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+#include <limits>
+
+void goap::update_heuristic(Heuristic &heur, const ActionTable &actions)
+{
+  heur.minActionCost = 1.f;
+  heur.maxVarsPerAction = 1;
+  heur.maxStep.fill(0);
+  heur.setValues.fill({});
+  heur.canIncrease.fill(false);
+  heur.canDecrease.fill(false);
+  for (size_t act = 0; act < actions.size(); ++act)
+    add_action_to_heuristic(heur, actions, act);
+}
+
+void goap::add_action_to_heuristic(Heuristic &heur, const ActionTable &actions, size_t act)
+{
+  const StateWords &setMask = actions.setMask[act];
+  const StateWords &addEffect = actions.addEffect[act];
+  heur.minActionCost = std::max(act == 0 ? actions.cost[act] : std::min(heur.minActionCost, actions.cost[act]), 0.f);
+  size_t numChanged = 0;
+  for (size_t i = 0; i < world_state_words; ++i)
+  {
+    const uint64_t changed = setMask[i] | lanes_nonzero_mask(addEffect[i]);
+    numChanged += size_t(std::popcount(changed)) / 8;
+    for (size_t lane = 0; lane < 8; ++lane)
+    {
+      const size_t shift = lane * 8;
+      const size_t var = i * 8 + lane;
+      const int8_t add = int8_t(uint8_t(addEffect[i] >> shift));
+      uint8_t step = 0;
+      if ((setMask[i] >> shift) & 0xff)
+      {
+        step = 0xff;
+        heur.setValues[var].set(uint8_t(actions.setEffect[act][i] >> shift));
+      }
+      else
+        step = uint8_t(abs(add));
+      heur.canIncrease[var] = heur.canIncrease[var] || add > 0;
+      heur.canDecrease[var] = heur.canDecrease[var] || add < 0;
+      uint8_t &maxStep = heur.maxStep[var];
+      maxStep = std::max(maxStep, step);
+    }
+  }
+  heur.maxVarsPerAction = std::max(heur.maxVarsPerAction, numChanged);
+}
+
+// a value some action sets can be moved further by additive effects in either direction they go
+static bool is_value_reachable(const goap::Heuristic &heur, size_t var, int from_val, int to_val)
+{
+  const std::bitset<256> &setValues = heur.setValues[var];
+  if (setValues.test(uint8_t(int8_t(to_val))))
+    return true;
+  return (heur.canIncrease[var] && (to_val > from_val || setValues.any())) ||
+         (heur.canDecrease[var] && (to_val < from_val || setValues.any()));
+}
+
+float goap::estimate_cost(const Heuristic &heur, const WorldState &from, const WorldState &to,
+                          const StateWords &to_care)
+{
+  if (heur.kind == HEURISTIC_NONE)
+    return 0.f;
+  float sumAbs = 0.f;
+  size_t numUnsatisfied = 0;
+  size_t maxSteps = 0;
+  for (size_t i = 0; i < world_state_words; ++i)
+  {
+    uint64_t diff = (from.words[i] ^ to.words[i]) & to_care[i];
+    while (diff != 0)
+    {
+      const int shift = std::countr_zero(diff) & ~7;
+      const int8_t fromVal = int8_t(uint8_t(from.words[i] >> shift));
+      const int8_t toVal = int8_t(uint8_t(to.words[i] >> shift));
+      const size_t var = i * 8 + size_t(shift / 8);
+      if (!is_value_reachable(heur, var, fromVal, toVal))
+        return std::numeric_limits<float>::infinity();
+      const int delta = abs(toVal - fromVal);
+      sumAbs += float(delta);
+      numUnsatisfied++;
+      // a variable no action touches can't be fixed at all, count it as one step to stay admissible
+      const int step = std::max(1, int(heur.maxStep[var]));
+      maxSteps = std::max(maxSteps, size_t((delta + step - 1) / step));
+      diff &= ~(0xffull << shift);
+    }
+  }
+  float h = sumAbs;
+  if (heur.kind == HEURISTIC_UNSATISFIED)
+    h = float(numUnsatisfied) * heur.minActionCost;
+  else if (heur.kind == HEURISTIC_MAX_PER_ACTION)
+  {
+    const size_t stepsForAll = (numUnsatisfied + heur.maxVarsPerAction - 1) / heur.maxVarsPerAction;
+    h = float(std::max(maxSteps, stepsForAll)) * heur.minActionCost;
+  }
+  return heur.weight * h;
+}
@@ -0,0 +1,36 @@
+#pragma once
+#include <bitset>
+#include "goapWorldState.h"
+#include "goapAction.h"
+
+namespace goap
+{
+  enum HeuristicKind
+  {
+    HEURISTIC_SUM_ABS, // sum of per variable differences, the original one, not admissible
+    HEURISTIC_UNSATISFIED, // number of unsatisfied variables times the cheapest action cost
+    HEURISTIC_MAX_PER_ACTION, // steps needed by the slowest variable, normalized by what one action can change, admissible
+    HEURISTIC_NONE // uniform cost search, slow but always optimal
+  };
+
+  struct Heuristic
+  {
+    HeuristicKind kind = HEURISTIC_SUM_ABS;
+    float weight = 1.f; // weighted A*: f = g + weight * h, plans are at most weight times worse with admissible h
+
+    // derived from planner actions
+    float minActionCost = 1.f;
+    size_t maxVarsPerAction = 1;
+    std::array<uint8_t, max_world_vars> maxStep = {}; // biggest change of a variable by one action, 0xff if set
+    // what actions can do to every variable, a target value none of it can produce is a dead end
+    std::array<std::bitset<256>, max_world_vars> setValues = {}; // by uint8_t(value)
+    std::array<bool, max_world_vars> canIncrease = {};
+    std::array<bool, max_world_vars> canDecrease = {};
+  };
+
+  void update_heuristic(Heuristic &heur, const ActionTable &actions);
+  // act has to be the next action after the ones already accounted for
+  void add_action_to_heuristic(Heuristic &heur, const ActionTable &actions, size_t act);
+  // infinite if some cared variable of to can't be reached from from by any sequence of actions
+  float estimate_cost(const Heuristic &heur, const WorldState &from, const WorldState &to, const StateWords &to_care);
+};
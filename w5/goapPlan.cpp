@@ -1,112 +1,611 @@
-#include "goapPlanner.h"
+#include "goapPlanSearch.h"
 #include <algorithm>
+#include <chrono>
+#include <limits>
+#include <queue>
 
 struct PlanNode
 {
   goap::WorldState worldState;
-  goap::WorldState prevState;
+  size_t hash = 0;
 
   float g = 0;
   float h = 0;
 
   size_t actionId;
+  size_t parent; // index in node list, size_t(-1) for the root
+  bool closed = false;
 };
 
-static float heuristic(const goap::WorldState &from, const goap::WorldState &to)
+struct OpenEntry
 {
-  float cost = 0;
-  for (size_t i = 0; i < to.size(); ++i)
-    if (to[i] >= 0) // we care about it
-      cost += float(abs(to[i] - from[i]));
-  return cost;
-}
+  float f = 0;
+  float h = 0;
+  size_t node;
+};
 
-static void reconstruct_plan(PlanNode &goal_node, const std::vector<PlanNode> &closed, std::vector<goap::PlanStep> &plan)
+// min-heap by f, on ties prefer nodes closer to the goal
+struct OpenEntryGreater
 {
-  PlanNode &curNode = goal_node;
-  while (curNode.actionId != size_t(-1))
+  bool operator()(const OpenEntry &lhs, const OpenEntry &rhs) const
   {
-    plan.push_back({curNode.actionId, curNode.worldState});
-    auto itf = std::find_if(closed.begin(), closed.end(), [&](const PlanNode &n) { return n.worldState == curNode.prevState; });
-    curNode = *itf;
+    return lhs.f > rhs.f || (lhs.f == rhs.f && lhs.h > rhs.h);
   }
-  std::reverse(plan.begin(), plan.end());
-}
+};
 
-float goap::make_plan(const Planner &planner, const WorldState &from, const WorldState &to, std::vector<PlanStep> &plan)
+// open addressing map from world state to node index, keys live in the node list itself
+class NodeTable
 {
-  std::vector<PlanNode> openList = {PlanNode{from, from, 0, heuristic(from, to), size_t(-1)}};
-  std::vector<PlanNode> closedList = {};
-  while (!openList.empty())
+  std::vector<size_t> slots; // node index + 1, 0 is an empty slot
+  size_t count = 0;
+
+  void grow(const std::vector<PlanNode> &nodes)
   {
-    auto minIt = openList.begin();
-    float minF = minIt->g + minIt->h;
-    for (auto it = openList.begin(); it != openList.end(); ++it)
-      if (it->g + it->h < minF)
+    std::vector<size_t> oldSlots(slots.empty() ? 64 : slots.size() * 2, 0);
+    oldSlots.swap(slots);
+    const size_t mask = slots.size() - 1;
+    for (size_t slot : oldSlots)
+      if (slot != 0)
       {
-        minF = it->g + it->h;
-        minIt = it;
+        size_t i = nodes[slot - 1].hash & mask;
+        while (slots[i] != 0)
+          i = (i + 1) & mask;
+        slots[i] = slot;
       }
-    PlanNode cur = *minIt;
-    openList.erase(minIt);
-    if (heuristic(cur.worldState, to) == 0) // we've reached our goal
+  }
+
+public:
+  // returns index of the node with this state, or inserts new_idx and returns it
+  size_t findOrInsert(const std::vector<PlanNode> &nodes, const goap::WorldState &ws, size_t hash, size_t new_idx)
+  {
+    if ((count + 1) * 2 > slots.size())
+      grow(nodes);
+    const size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i] != 0)
+    {
+      const PlanNode &node = nodes[slots[i] - 1];
+      if (node.hash == hash && node.worldState == ws)
+        return slots[i] - 1;
+      i = (i + 1) & mask;
+    }
+    slots[i] = new_idx + 1;
+    count++;
+    return new_idx;
+  }
+
+  size_t memoryUsage() const { return slots.capacity() * sizeof(size_t); }
+};
+
+enum RelaxResult
+{
+  RELAX_NONE,
+  RELAX_NEW,
+  RELAX_IMPROVED // known node reached with a lower g
+};
+
+// one direction of A*: node storage, state lookup and the open list
+struct Search
+{
+  std::vector<PlanNode> nodes;
+  NodeTable nodeIndices;
+  std::priority_queue<OpenEntry, std::vector<OpenEntry>, OpenEntryGreater> openList;
+
+  void reset(const goap::WorldState &start, float h)
+  {
+    nodes.clear();
+    nodeIndices = NodeTable{};
+    openList = {};
+    nodes.push_back(PlanNode{start, start.hash(), 0, h, size_t(-1), size_t(-1)});
+    nodeIndices.findOrInsert(nodes, start, nodes[0].hash, 0);
+    if (h < std::numeric_limits<float>::infinity())
+      openList.push({h, h, 0});
+  }
+
+  // entries are never updated in place, so skip the ones superseded by a cheaper path
+  void dropStale()
+  {
+    while (!openList.empty())
     {
-      reconstruct_plan(cur, closedList, plan);
-      return minF;
+      const OpenEntry &top = openList.top();
+      if (!nodes[top.node].closed && top.f <= nodes[top.node].g + nodes[top.node].h)
+        return;
+      openList.pop();
     }
-    closedList.push_back(cur);
-    std::vector<size_t> transitions = find_valid_state_transitions(planner, cur.worldState);
-    for (size_t actId : transitions)
+  }
+
+  // next node to expand or size_t(-1) if there is none
+  size_t popOpen()
+  {
+    dropStale();
+    if (openList.empty())
+      return size_t(-1);
+    const size_t node = openList.top().node;
+    openList.pop();
+    return node;
+  }
+
+  float minOpenF()
+  {
+    dropStale();
+    return openList.empty() ? std::numeric_limits<float>::infinity() : openList.top().f;
+  }
+
+  // adds a successor or updates a known one if the new path is cheaper
+  template<typename HeuristicFn>
+  RelaxResult relax(const goap::WorldState &ws, float score, size_t act_id, size_t parent, HeuristicFn heur,
+                    size_t &node_idx)
+  {
+    const size_t hash = ws.hash();
+    node_idx = nodeIndices.findOrInsert(nodes, ws, hash, nodes.size());
+    if (node_idx == nodes.size())
     {
-      WorldState st = apply_action(planner, actId, cur.worldState);
-      float score = cur.g + get_action_cost(planner, actId);
-      auto openIt = std::find_if(openList.begin(), openList.end(), [&](const PlanNode &n) { return st == n.worldState; });
-      auto closeIt = std::find_if(closedList.begin(), closedList.end(), [&](const PlanNode &n) { return st == n.worldState; });
-      if (openIt != openList.end() && score < openIt->g)
+      const float h = heur(ws);
+      nodes.push_back(PlanNode{ws, hash, score, h, act_id, parent});
+      // dead ends are kept as nodes, so finding them again doesn't recompute the heuristic, but never expanded
+      if (h < std::numeric_limits<float>::infinity())
+        openList.push({score + h, h, node_idx});
+      return RELAX_NEW;
+    }
+    PlanNode &node = nodes[node_idx];
+    if (score >= node.g || node.h == std::numeric_limits<float>::infinity())
+      return RELAX_NONE;
+    // heuristic is not consistent, so closed nodes may be reopened with a better score
+    node.g = score;
+    node.parent = parent;
+    node.actionId = act_id;
+    node.closed = false;
+    openList.push({score + node.h, node.h, node_idx});
+    return RELAX_IMPROVED;
+  }
+
+  // open list is a priority_queue which hides its capacity, so it's counted by size
+  size_t memoryUsage() const
+  {
+    return nodes.capacity() * sizeof(PlanNode) + nodeIndices.memoryUsage() + openList.size() * sizeof(OpenEntry);
+  }
+};
+
+// changed_nodes gets both new nodes and the ones reached with a lower g
+static void expand_forward(const goap::Planner &planner, Search &search, size_t idx, const goap::WorldState &to,
+                           const goap::StateWords &to_care, goap::ActionMask &transitions, goap::PlanStats &st,
+                           std::vector<size_t> *changed_nodes = nullptr)
+{
+  search.nodes[idx].closed = true;
+  st.nodesExpanded++;
+  const goap::WorldState cur = search.nodes[idx].worldState;
+  const float curG = search.nodes[idx].g;
+  const auto heur = [&](const goap::WorldState &s) { return goap::estimate_cost(planner.heuristic, s, to, to_care); };
+  goap::find_valid_state_transitions(planner, cur, transitions);
+  goap::for_each_action(transitions, [&](size_t actId)
+  {
+    const goap::WorldState ws = goap::apply_action_effect(planner.actions, actId, cur);
+    size_t nodeIdx = 0;
+    const RelaxResult res = search.relax(ws, curG + planner.actions.cost[actId], actId, idx, heur, nodeIdx);
+    if (res == RELAX_NEW)
+      st.nodesGenerated++;
+    if (res != RELAX_NONE && changed_nodes)
+      changed_nodes->push_back(nodeIdx);
+  });
+}
+
+// backward nodes are partial states: constraints which must hold to reach the goal
+static void expand_backward(const goap::Planner &planner, Search &search, size_t idx, const goap::WorldState &from,
+                            goap::PlanStats &st, std::vector<size_t> *changed_nodes = nullptr)
+{
+  search.nodes[idx].closed = true;
+  st.nodesExpanded++;
+  const goap::WorldState cur = search.nodes[idx].worldState;
+  const float curG = search.nodes[idx].g;
+  const auto heur = [&](const goap::WorldState &s) { return goap::estimate_cost(planner.heuristic, from, s, s.careMask()); };
+  goap::WorldState ws;
+  for (size_t actId = 0; actId < planner.actions.size(); ++actId)
+  {
+    if (!goap::regress_action_effect(planner.actions, actId, cur, ws))
+      continue;
+    size_t nodeIdx = 0;
+    const RelaxResult res = search.relax(ws, curG + planner.actions.cost[actId], actId, idx, heur, nodeIdx);
+    if (res == RELAX_NEW)
+      st.nodesGenerated++;
+    if (res != RELAX_NONE && changed_nodes)
+      changed_nodes->push_back(nodeIdx);
+  }
+}
+
+static void reconstruct_plan(const std::vector<PlanNode> &nodes, size_t goal_node, std::vector<goap::PlanStep> &plan)
+{
+  for (size_t idx = goal_node; nodes[idx].parent != size_t(-1); idx = nodes[idx].parent)
+    plan.push_back({nodes[idx].actionId, nodes[idx].worldState});
+  std::reverse(plan.begin(), plan.end());
+}
+
+// backward chain from a node to the goal root is already in execution order,
+// world states are restored by replaying actions from the actual state
+static void append_backward_plan(const goap::Planner &planner, const std::vector<PlanNode> &nodes, size_t node,
+                                 goap::WorldState cur, std::vector<goap::PlanStep> &plan)
+{
+  for (size_t idx = node; nodes[idx].parent != size_t(-1); idx = nodes[idx].parent)
+  {
+    cur = goap::apply_action_effect(planner.actions, nodes[idx].actionId, cur);
+    plan.push_back({nodes[idx].actionId, cur});
+  }
+}
+
+// open addressing map from a state masked to some lanes to the node with the lowest g among those having it
+class CheapestByState
+{
+  struct Slot
+  {
+    size_t hash;
+    size_t node; // node index + 1, 0 is an empty slot
+  };
+  std::vector<Slot> slots;
+  size_t count = 0;
+
+  void grow()
+  {
+    std::vector<Slot> oldSlots(slots.empty() ? 64 : slots.size() * 2, Slot{0, 0});
+    oldSlots.swap(slots);
+    const size_t mask = slots.size() - 1;
+    for (const Slot &slot : oldSlots)
+      if (slot.node != 0)
       {
-        openIt->g = score;
-        openIt->prevState = cur.worldState;
+        size_t i = slot.hash & mask;
+        while (slots[i].node != 0)
+          i = (i + 1) & mask;
+        slots[i] = slot;
       }
-      if (closeIt != closedList.end() && score < closeIt->g)
+  }
+
+public:
+  // adds the node, or replaces the one stored for its state if the node is cheaper
+  void update(const std::vector<PlanNode> &nodes, const goap::StateWords &care, size_t hash, size_t node)
+  {
+    if ((count + 1) * 2 > slots.size())
+      grow();
+    const size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    for (; slots[i].node != 0; i = (i + 1) & mask)
+      if (slots[i].hash == hash && nodes[slots[i].node - 1].worldState.matches(nodes[node].worldState.words, care))
+      {
+        if (nodes[node].g < nodes[slots[i].node - 1].g)
+          slots[i].node = node + 1;
+        return;
+      }
+    slots[i] = Slot{hash, node + 1};
+    count++;
+  }
+
+  // node stored for the state of ws masked to care, size_t(-1) if there is none
+  size_t find(const std::vector<PlanNode> &nodes, const goap::StateWords &care, const goap::WorldState &ws,
+              size_t hash) const
+  {
+    if (slots.empty())
+      return size_t(-1);
+    const size_t mask = slots.size() - 1;
+    for (size_t i = hash & mask; slots[i].node != 0; i = (i + 1) & mask)
+      if (slots[i].hash == hash && nodes[slots[i].node - 1].worldState.matches(ws.words, care))
+        return slots[i].node - 1;
+    return size_t(-1);
+  }
+
+  size_t memoryUsage() const { return slots.capacity() * sizeof(Slot); }
+};
+
+// Finds the cheapest meetings of forward states and backward nodes without scanning the other side.
+// Backward nodes are grouped by the lanes they constrain, and each group keeps the cheapest node of
+// either side per state masked to just those lanes. Regression only ever constrains precondition and
+// goal lanes, so there are few groups.
+class MeetIndex
+{
+  struct Group
+  {
+    goap::StateWords care;
+    CheapestByState fwd;
+    CheapestByState bwd;
+  };
+  std::vector<Group> groups;
+  std::vector<size_t> bwdGroup; // per backward node
+  size_t numFwd = 0;
+
+  // same mixing as WorldState::hash, but words nobody in the group cares about are skipped
+  static size_t masked_hash(const goap::WorldState &ws, const goap::StateWords &care)
+  {
+    uint64_t res = 0;
+    for (size_t i = 0; i < goap::world_state_words; ++i)
+      if (care[i] != 0)
+        res = (res ^ (ws.words[i] & care[i])) * 0x9e3779b97f4a7c15ull;
+    res ^= res >> 33;
+    res *= 0xff51afd7ed558ccdull;
+    return res ^ (res >> 33);
+  }
+
+public:
+  // for new forward nodes and the ones reached with a lower g
+  void updateForward(const std::vector<PlanNode> &fwd, size_t node)
+  {
+    for (Group &group : groups)
+      group.fwd.update(fwd, group.care, masked_hash(fwd[node].worldState, group.care), node);
+    numFwd = std::max(numFwd, node + 1);
+  }
+
+  // same for backward nodes, they are added in order
+  void updateBackward(const std::vector<PlanNode> &fwd, const std::vector<PlanNode> &bwd, size_t node)
+  {
+    if (node == bwdGroup.size())
+    {
+      const goap::StateWords care = bwd[node].worldState.careMask();
+      auto itg = std::find_if(groups.begin(), groups.end(), [&](const Group &group) { return group.care == care; });
+      if (itg == groups.end())
       {
-        closeIt->g = score;
-        closeIt->prevState = cur.worldState;
+        Group &group = groups.emplace_back(Group{care, {}, {}});
+        for (size_t i = 0; i < numFwd; ++i)
+          group.fwd.update(fwd, care, masked_hash(fwd[i].worldState, care), i);
+        itg = groups.end() - 1;
       }
-      if (closeIt == closedList.end() && openIt == openList.end())
-        openList.push_back({st, cur.worldState, score, heuristic(st, to), actId});
+      bwdGroup.push_back(size_t(itg - groups.begin()));
     }
+    Group &group = groups[bwdGroup[node]];
+    group.bwd.update(bwd, group.care, masked_hash(bwd[node].worldState, group.care), node);
   }
-  return 0.f;
-}
 
-void goap::print_plan(const Planner &planner, const WorldState &init, const std::vector<PlanStep> &plan)
+  // calls fn with the cheapest backward node of every group the forward node satisfies
+  template<typename Callable>
+  void meetForward(const std::vector<PlanNode> &fwd, const std::vector<PlanNode> &bwd, size_t node, Callable fn) const
+  {
+    for (const Group &group : groups)
+    {
+      const goap::WorldState &ws = fwd[node].worldState;
+      const size_t bwdNode = group.bwd.find(bwd, group.care, ws, masked_hash(ws, group.care));
+      if (bwdNode != size_t(-1))
+        fn(bwdNode);
+    }
+  }
+
+  // calls fn with the cheapest forward node which satisfies the backward one
+  template<typename Callable>
+  void meetBackward(const std::vector<PlanNode> &fwd, const std::vector<PlanNode> &bwd, size_t node, Callable fn) const
+  {
+    const Group &group = groups[bwdGroup[node]];
+    const goap::WorldState &ws = bwd[node].worldState;
+    const size_t fwdNode = group.fwd.find(fwd, group.care, ws, masked_hash(ws, group.care));
+    if (fwdNode != size_t(-1))
+      fn(fwdNode);
+  }
+
+  size_t memoryUsage() const
+  {
+    size_t res = groups.capacity() * sizeof(Group) + bwdGroup.capacity() * sizeof(size_t);
+    for (const Group &group : groups)
+      res += group.fwd.memoryUsage() + group.bwd.memoryUsage();
+    return res;
+  }
+};
+
+struct goap::PlanSearch::Impl
 {
-  printf("%15s: ", "");
-  std::vector<int> dlen;
-  for (size_t i = 0; i < planner.wdesc.size(); ++i)
+  const Planner &planner;
+  WorldState from;
+  WorldState to;
+  StateWords toCare;
+  SearchMode mode;
+
+  Search fwd;
+  Search bwd;
+  MeetIndex meetIndex;
+  float bestMeetCost = std::numeric_limits<float>::infinity(); // cheapest plan through a meeting found so far
+  size_t meetFwd = 0;
+  size_t meetBwd = 0;
+  bool forwardTurn = true;
+  size_t bestNode = 0; // forward node with the lowest heuristic so far
+  ActionMask transitions;
+  std::vector<size_t> newNodes;
+
+  PlanStatus status = PLAN_IN_PROGRESS;
+  std::vector<PlanStep> plan;
+  float cost = 0.f;
+  PlanStats stats;
+
+  Impl(const Planner &pl, const WorldState &in_from, const WorldState &in_to, SearchMode in_mode)
+    : planner(pl), from(in_from), to(in_to), toCare(in_to.careMask()), mode(in_mode)
+  {
+    const float startH = estimate_cost(planner.heuristic, from, to, toCare);
+    if (mode != SEARCH_BACKWARD)
+      fwd.reset(from, startH);
+    if (mode != SEARCH_FORWARD)
+      bwd.reset(to, startH);
+    if (mode == SEARCH_BIDIRECTIONAL)
+    {
+      meetIndex.updateForward(fwd.nodes, 0);
+      meetIndex.updateBackward(fwd.nodes, bwd.nodes, 0);
+      meetIndex.meetBackward(fwd.nodes, bwd.nodes, 0, [&](size_t fwd_node) { updateMeet(fwd_node, 0); });
+    }
+  }
+
+  PlanStatus found(float plan_cost)
+  {
+    cost = plan_cost;
+    return status = PLAN_FOUND;
+  }
+
+  PlanStatus expandForward()
+  {
+    const size_t idx = fwd.popOpen();
+    if (idx == size_t(-1))
+      return status = PLAN_FAILED;
+    if (fwd.nodes[idx].h < fwd.nodes[bestNode].h)
+      bestNode = idx;
+    if (fwd.nodes[idx].worldState.matches(to.words, toCare)) // we've reached our goal
+    {
+      reconstruct_plan(fwd.nodes, idx, plan);
+      return found(fwd.nodes[idx].g);
+    }
+    expand_forward(planner, fwd, idx, to, toCare, transitions, stats);
+    return status;
+  }
+
+  PlanStatus expandBackward()
+  {
+    const size_t idx = bwd.popOpen();
+    if (idx == size_t(-1))
+      return status = PLAN_FAILED;
+    const WorldState &constraints = bwd.nodes[idx].worldState;
+    if (from.matches(constraints.words, constraints.careMask())) // current state satisfies all we need
+    {
+      append_backward_plan(planner, bwd.nodes, idx, from, plan);
+      return found(bwd.nodes[idx].g);
+    }
+    expand_backward(planner, bwd, idx, from, stats);
+    return status;
+  }
+
+  void updateMeet(size_t fwd_node, size_t bwd_node)
+  {
+    const float meetCost = fwd.nodes[fwd_node].g + bwd.nodes[bwd_node].g;
+    if (meetCost < bestMeetCost)
+    {
+      bestMeetCost = meetCost;
+      meetFwd = fwd_node;
+      meetBwd = bwd_node;
+    }
+  }
+
+  PlanStatus meet(size_t fwd_node, size_t bwd_node)
+  {
+    reconstruct_plan(fwd.nodes, fwd_node, plan);
+    append_backward_plan(planner, bwd.nodes, bwd_node, fwd.nodes[fwd_node].worldState, plan);
+    return found(fwd.nodes[fwd_node].g + bwd.nodes[bwd_node].g);
+  }
+
+  // Alternates forward and backward expansions and keeps the cheapest meeting of the two sides.
+  // A plan not found yet goes through an open node on each side, so with an admissible heuristic
+  // it costs at least the bigger of the two lowest f; once the best meeting is that cheap it's optimal.
+  PlanStatus expandBidirectional()
   {
-    // print names by searching
-    for (auto it : planner.wdesc)
+    if (bestMeetCost <= std::max(fwd.minOpenF(), bwd.minOpenF())) // an exhausted side counts as infinite
+      return bestMeetCost < std::numeric_limits<float>::infinity() ? meet(meetFwd, meetBwd) : status = PLAN_FAILED;
+    const bool forward = forwardTurn;
+    forwardTurn = !forwardTurn;
+    newNodes.clear();
+    if (forward)
     {
-      if (it.second == i)
+      const size_t idx = fwd.popOpen();
+      if (fwd.nodes[idx].h < fwd.nodes[bestNode].h)
+        bestNode = idx;
+      expand_forward(planner, fwd, idx, to, toCare, transitions, stats, &newNodes);
+      // a node can be listed twice when two actions lead to it, that only repeats the update
+      for (size_t node : newNodes)
       {
-        printf("|%s|", it.first.c_str());
-        dlen.push_back(int(it.first.size()));
-        break;
+        meetIndex.updateForward(fwd.nodes, node);
+        meetIndex.meetForward(fwd.nodes, bwd.nodes, node, [&](size_t bwd_node) { updateMeet(node, bwd_node); });
       }
+      return status;
+    }
+    const size_t idx = bwd.popOpen();
+    expand_backward(planner, bwd, idx, from, stats, &newNodes);
+    for (size_t node : newNodes)
+    {
+      meetIndex.updateBackward(fwd.nodes, bwd.nodes, node);
+      meetIndex.meetBackward(fwd.nodes, bwd.nodes, node, [&](size_t fwd_node) { updateMeet(fwd_node, node); });
     }
+    return status;
   }
+
+  PlanStatus expandOne()
+  {
+    if (mode == SEARCH_BACKWARD)
+      expandBackward();
+    else if (mode == SEARCH_BIDIRECTIONAL)
+      expandBidirectional();
+    else
+      expandForward();
+    const size_t bytes = fwd.memoryUsage() + bwd.memoryUsage() + meetIndex.memoryUsage();
+    stats.peakSearchBytes = std::max(stats.peakSearchBytes, bytes);
+    return status;
+  }
+};
+
+goap::PlanSearch::PlanSearch(const Planner &planner, const WorldState &from, const WorldState &to, SearchMode mode)
+  : impl(std::make_unique<Impl>(planner, from, to, mode))
+{
+}
+
+goap::PlanSearch::PlanSearch(PlanSearch &&) noexcept = default;
+goap::PlanSearch &goap::PlanSearch::operator=(PlanSearch &&) noexcept = default;
+goap::PlanSearch::~PlanSearch() = default;
+
+goap::PlanStatus goap::PlanSearch::step(const PlanBudget &budget)
+{
+  using Clock = std::chrono::steady_clock;
+  constexpr size_t expansionsPerClockCheck = 16;
+  const Clock::time_point start = Clock::now();
+  for (size_t i = 0; i < budget.expansions && impl->status == PLAN_IN_PROGRESS; ++i)
+  {
+    impl->expandOne();
+    if (budget.microseconds > 0.f && i % expansionsPerClockCheck == expansionsPerClockCheck - 1 &&
+        std::chrono::duration<float, std::micro>(Clock::now() - start).count() >= budget.microseconds)
+      break;
+  }
+  return impl->status;
+}
+
+goap::PlanStatus goap::PlanSearch::status() const
+{
+  return impl->status;
+}
+
+const std::vector<goap::PlanStep> &goap::PlanSearch::plan() const
+{
+  return impl->plan;
+}
+
+float goap::PlanSearch::cost() const
+{
+  return impl->cost;
+}
+
+const goap::PlanStats &goap::PlanSearch::stats() const
+{
+  return impl->stats;
+}
+
+void goap::PlanSearch::partialPlan(std::vector<PlanStep> &res) const
+{
+  res.clear();
+  if (impl->status == PLAN_FOUND)
+    res = impl->plan;
+  else if (!impl->fwd.nodes.empty())
+    reconstruct_plan(impl->fwd.nodes, impl->bestNode, res);
+}
+
+float goap::make_plan(const Planner &planner, const WorldState &from, const WorldState &to, std::vector<PlanStep> &plan,
+                      SearchMode mode, PlanStats *stats)
+{
+  PlanSearch search(planner, from, to, mode);
+  search.step(PlanBudget{});
+  if (stats)
+    *stats = search.stats();
+  if (search.status() != PLAN_FOUND)
+    return 0.f;
+  plan.insert(plan.end(), search.plan().begin(), search.plan().end());
+  return search.cost();
+}
+
+void goap::print_plan(const Planner &planner, const WorldState &init, const std::vector<PlanStep> &plan)
+{
+  printf("%15s: ", "");
+  for (const std::string &name : planner.varNames)
+    printf("|%s|", name.c_str());
   printf("\n");
   printf("%15s: ", "");
-  for (size_t i = 0; i < init.size(); ++i)
-    printf("|%*d|", dlen[i], init[i]);
+  for (size_t i = 0; i < planner.varNames.size(); ++i)
+    printf("|%*d|", int(planner.varNames[i].size()), init.get(i));
   printf("\n");
   for (const PlanStep &step : plan)
   {
-    printf("%15s: ", planner.actions[step.action].name.c_str());
-    for (size_t i = 0; i < step.worldState.size(); ++i)
-      printf("|%*d|", dlen[i], step.worldState[i]);
+    printf("%15s: ", planner.actionNames[step.action].c_str());
+    for (size_t i = 0; i < planner.varNames.size(); ++i)
+      printf("|%*d|", int(planner.varNames[i].size()), step.worldState.get(i));
     printf("\n");
   }
 }
-
@@ -0,0 +1,168 @@
+#include "goapPlanner.h"
+#include "goapPlanSearch.h"
+#include <algorithm>
+
+static size_t plan_key(const goap::WorldState &from, const goap::WorldState &to)
+{
+  return from.hash() ^ (to.hash() * 0x9e3779b97f4a7c15ull);
+}
+
+static size_t find_entry(const goap::PlanCache &cache, size_t key, const goap::WorldState &from, const goap::WorldState &to)
+{
+  auto itf = cache.lookup.find(key);
+  if (itf == cache.lookup.end())
+    return size_t(-1);
+  for (size_t idx : itf->second)
+    if (cache.entries[idx].from == from && cache.entries[idx].to == to)
+      return idx;
+  return size_t(-1);
+}
+
+static void unlink_entry(goap::PlanCache &cache, size_t idx)
+{
+  const goap::PlanCache::Entry &entry = cache.entries[idx];
+  auto itf = cache.lookup.find(plan_key(entry.from, entry.to));
+  if (itf == cache.lookup.end())
+    return;
+  itf->second.erase(std::remove(itf->second.begin(), itf->second.end(), idx), itf->second.end());
+  if (itf->second.empty())
+    cache.lookup.erase(itf);
+}
+
+static void unlink_recency(goap::PlanCache &cache, size_t idx)
+{
+  goap::PlanCache::Entry &entry = cache.entries[idx];
+  if (entry.newer != goap::PlanCache::no_entry)
+    cache.entries[entry.newer].older = entry.older;
+  else
+    cache.newest = entry.older;
+  if (entry.older != goap::PlanCache::no_entry)
+    cache.entries[entry.older].newer = entry.newer;
+  else
+    cache.oldest = entry.newer;
+  entry.newer = entry.older = goap::PlanCache::no_entry;
+}
+
+static void push_newest(goap::PlanCache &cache, size_t idx)
+{
+  goap::PlanCache::Entry &entry = cache.entries[idx];
+  entry.newer = goap::PlanCache::no_entry;
+  entry.older = cache.newest;
+  if (cache.newest != goap::PlanCache::no_entry)
+    cache.entries[cache.newest].newer = idx;
+  else
+    cache.oldest = idx;
+  cache.newest = idx;
+}
+
+static void store_entry(goap::PlanCache &cache, size_t key, const goap::WorldState &from, const goap::WorldState &to,
+                        const std::vector<goap::PlanStep> &plan, const goap::PlanResult &res)
+{
+  if (cache.capacity == 0)
+    return;
+  size_t idx = cache.entries.size();
+  if (cache.entries.size() < cache.capacity)
+    cache.entries.emplace_back();
+  else
+  {
+    idx = cache.oldest;
+    unlink_recency(cache, idx);
+    unlink_entry(cache, idx);
+    cache.stats.evictions++;
+  }
+  goap::PlanCache::Entry &entry = cache.entries[idx];
+  entry.from = from;
+  entry.to = to;
+  entry.plan = plan;
+  entry.cost = res.cost;
+  entry.found = res.found;
+  push_newest(cache, idx);
+  cache.lookup[key].push_back(idx);
+}
+
+goap::PlanResult goap::make_cached_plan(Planner &planner, const WorldState &from, const WorldState &to,
+                                        std::vector<PlanStep> &plan)
+{
+  PlanCache &cache = planner.planCache;
+  const size_t key = plan_key(from, to);
+  const size_t idx = find_entry(cache, key, from, to);
+  if (idx != size_t(-1))
+  {
+    cache.stats.hits++;
+    unlink_recency(cache, idx);
+    push_newest(cache, idx);
+    const PlanCache::Entry &entry = cache.entries[idx];
+    plan = entry.plan;
+    return PlanResult{entry.cost, entry.found};
+  }
+  cache.stats.misses++;
+  plan.clear();
+  PlanSearch search(planner, from, to);
+  search.step(PlanBudget{});
+  PlanResult res;
+  if (search.status() == PLAN_FOUND)
+  {
+    plan = search.plan();
+    res = PlanResult{search.cost(), true};
+  }
+  store_entry(cache, key, from, to, plan, res);
+  return res;
+}
+
+static goap::PlanResult replan_suffix(goap::Planner &planner, const goap::WorldState &cur, const goap::WorldState &to,
+                                      std::vector<goap::PlanStep> &plan, float prefix_cost)
+{
+  planner.planCache.stats.repairs++;
+  planner.planCache.stats.repairedSteps += plan.size();
+  std::vector<goap::PlanStep> suffix;
+  const goap::PlanResult suffixRes = goap::make_cached_plan(planner, cur, to, suffix);
+  if (!suffixRes.found) // goal is unreachable from here
+  {
+    plan.clear();
+    return goap::PlanResult{};
+  }
+  plan.insert(plan.end(), suffix.begin(), suffix.end());
+  return goap::PlanResult{prefix_cost + suffixRes.cost, true};
+}
+
+goap::PlanResult goap::repair_plan(Planner &planner, const WorldState &from, const WorldState &to, std::vector<PlanStep> &plan)
+{
+  const StateWords toCare = to.careMask();
+  WorldState cur = from;
+  float cost = 0.f;
+  for (size_t i = 0; i < plan.size(); ++i)
+  {
+    if (cur.matches(to.words, toCare))
+    {
+      // reached the goal earlier than the old plan did
+      plan.resize(i);
+      return PlanResult{cost, true};
+    }
+    const size_t act = plan[i].action;
+    if (!is_action_valid(planner.actions, act, cur))
+    {
+      plan.resize(i);
+      return replan_suffix(planner, cur, to, plan, cost);
+    }
+    cur = apply_action_effect(planner.actions, act, cur);
+    plan[i].worldState = cur;
+    cost += planner.actions.cost[act];
+  }
+  if (cur.matches(to.words, toCare))
+    return PlanResult{cost, true};
+  // whole plan is still valid but doesn't lead to the goal anymore, extend it
+  return replan_suffix(planner, cur, to, plan, cost);
+}
+
+void goap::set_plan_cache_capacity(Planner &planner, size_t capacity)
+{
+  planner.planCache.capacity = capacity;
+  clear_plan_cache(planner);
+}
+
+void goap::clear_plan_cache(Planner &planner)
+{
+  planner.planCache.entries.clear();
+  planner.planCache.lookup.clear();
+  planner.planCache.newest = planner.planCache.oldest = PlanCache::no_entry;
+}
@@ -0,0 +1,73 @@
+#include "goapPlanScheduler.h"
+#include <algorithm>
+#include <chrono>
+
+goap::PlanScheduler::Handle goap::PlanScheduler::submit(const Planner &planner, const WorldState &from,
+                                                        const WorldState &to, SearchMode mode)
+{
+  const Handle handle = nextHandle++;
+  searches.emplace(handle, PlanSearch(planner, from, to, mode));
+  pending.push_back(handle);
+  return handle;
+}
+
+void goap::PlanScheduler::cancel(Handle handle)
+{
+  searches.erase(handle);
+  auto itf = std::find(pending.begin(), pending.end(), handle);
+  if (itf == pending.end())
+    return;
+  if (size_t(itf - pending.begin()) < cursor)
+    cursor--;
+  pending.erase(itf);
+}
+
+void goap::PlanScheduler::update(const PlanBudget &budget, size_t min_slice)
+{
+  using Clock = std::chrono::steady_clock;
+  const Clock::time_point start = Clock::now();
+  size_t expansionsLeft = budget.expansions;
+  size_t turnsLeft = 0; // searches which haven't had their share of this round yet
+  while (!pending.empty() && expansionsLeft > 0)
+  {
+    const float elapsed = std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+    if (budget.microseconds > 0.f && elapsed >= budget.microseconds)
+      break;
+
+    if (cursor >= pending.size())
+      cursor = 0;
+    if (turnsLeft == 0)
+      turnsLeft = pending.size();
+    // time is split like expansions, otherwise the first search would run until the whole frame is gone,
+    // what a search leaves unused goes to the ones after it
+    const size_t slice = std::min(expansionsLeft, std::max(min_slice, expansionsLeft / pending.size()));
+    const float timeShare = budget.microseconds > 0.f ? (budget.microseconds - elapsed) / float(turnsLeft) : 0.f;
+    turnsLeft--;
+    PlanSearch &search = searches.at(pending[cursor]);
+    const size_t expandedBefore = search.stats().nodesExpanded;
+    const PlanStatus st = search.step(PlanBudget{slice, timeShare});
+    // count what was actually spent, a search may finish early
+    expansionsLeft -= std::min(expansionsLeft, std::max<size_t>(1, search.stats().nodesExpanded - expandedBefore));
+    if (st != PLAN_IN_PROGRESS)
+      pending.erase(pending.begin() + ptrdiff_t(cursor)); // finished, result waits in searches
+    else
+      cursor++;
+  }
+}
+
+goap::PlanStatus goap::PlanScheduler::status(Handle handle) const
+{
+  auto itf = searches.find(handle);
+  return itf != searches.end() ? itf->second.status() : PLAN_FAILED;
+}
+
+bool goap::PlanScheduler::takeResult(Handle handle, std::vector<PlanStep> &plan, float &cost)
+{
+  auto itf = searches.find(handle);
+  if (itf == searches.end() || itf->second.status() == PLAN_IN_PROGRESS)
+    return false;
+  plan = itf->second.plan();
+  cost = itf->second.cost();
+  searches.erase(itf);
+  return true;
+}
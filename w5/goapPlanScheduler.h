@@ -0,0 +1,36 @@
+#pragma once
+#include <unordered_map>
+#include <vector>
+#include "goapPlanSearch.h"
+
+namespace goap
+{
+  // Runs many plan searches with a shared per-frame budget, round-robin between them
+  // so the frame cost is bounded no matter how many agents are waiting for a plan.
+  // Both expansions and time are split evenly between the pending searches.
+  class PlanScheduler
+  {
+  public:
+    using Handle = size_t;
+    static constexpr Handle invalid_handle = 0;
+
+    // planner has to outlive the request
+    Handle submit(const Planner &planner, const WorldState &from, const WorldState &to, SearchMode mode = SEARCH_FORWARD);
+    void cancel(Handle handle);
+
+    // spends the budget on pending searches, min_slice is the least number of expansions given to one search in a row
+    void update(const PlanBudget &budget, size_t min_slice = 8);
+
+    PlanStatus status(Handle handle) const;
+    // moves the result out of a finished search and forgets the handle, returns false if it's still in progress
+    bool takeResult(Handle handle, std::vector<PlanStep> &plan, float &cost);
+
+    size_t pendingCount() const { return pending.size(); }
+
+  private:
+    Handle nextHandle = 1;
+    std::unordered_map<Handle, PlanSearch> searches;
+    std::vector<Handle> pending; // round-robin order
+    size_t cursor = 0;
+  };
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include <memory>
+#include "goapPlanner.h"
+
+namespace goap
+{
+  enum PlanStatus
+  {
+    PLAN_IN_PROGRESS,
+    PLAN_FOUND,
+    PLAN_FAILED
+  };
+
+  struct PlanBudget
+  {
+    size_t expansions = size_t(-1);
+    float microseconds = 0.f; // 0 - no time limit
+  };
+
+  // A* plan search which can be stopped once the budget is spent and resumed later.
+  // Keeps a reference to the planner, it has to outlive the search.
+  class PlanSearch
+  {
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+  public:
+    PlanSearch(const Planner &planner, const WorldState &from, const WorldState &to, SearchMode mode = SEARCH_FORWARD);
+    PlanSearch(PlanSearch &&) noexcept;
+    PlanSearch &operator=(PlanSearch &&) noexcept;
+    ~PlanSearch();
+
+    PlanStatus step(const PlanBudget &budget);
+    PlanStatus status() const;
+
+    // valid when status is PLAN_FOUND
+    const std::vector<PlanStep> &plan() const;
+    float cost() const;
+    const PlanStats &stats() const;
+
+    // plan to the node closest to the goal found so far (forward search only)
+    void partialPlan(std::vector<PlanStep> &res) const;
+  };
+};
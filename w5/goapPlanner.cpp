@@ -5,10 +5,18 @@ goap::Planner goap::create_planner()
   return Planner();
 }
 
-void goap::add_states_to_planner(Planner &planner, const std::vector<std::string> &state_names)
+bool goap::add_states_to_planner(Planner &planner, const std::vector<std::string> &state_names)
 {
   for (const std::string &name : state_names)
+  {
+    if (planner.wdesc.count(name))
+      continue;
+    if (planner.wdesc.size() >= max_world_vars)
+      return false;
     planner.wdesc.emplace(name, planner.wdesc.size());
+    planner.varNames.push_back(name);
+  }
+  return true;
 }
 
 
@@ -16,7 +24,7 @@ void goap::add_action_to_planner(Planner &planner, const char *name, float cost,
                                                                                  const Effect &effect,
                                                                                  const Effect &additive_effect)
 {
-  Action act = create_action(name, planner.wdesc, cost);
+  Action act = create_action(cost);
   for (auto st : precond)
     set_action_precond(act, planner.wdesc, st.first, int8_t(st.second));
   for (auto st : effect)
@@ -24,8 +32,20 @@ void goap::add_action_to_planner(Planner &planner, const char *name, float cost,
   for (auto st : additive_effect)
     set_additive_action_effect(act, planner.wdesc, st.first, int8_t(st.second));
 
-  planner.actionNames.emplace(name, planner.actions.size());
-  planner.actions.emplace_back(act);
+  const size_t actId = add_action(planner.actions, act);
+  planner.actionNames.emplace_back(name);
+  // both are updated with just this action, so building a planner is linear in the number of actions
+  add_to_precondition_index(planner.preconditionIndex, planner.actions, actId);
+  add_action_to_heuristic(planner.heuristic, planner.actions, actId);
+  if (!planner.planCache.entries.empty())
+    clear_plan_cache(planner);
+}
+
+void goap::set_planner_heuristic(Planner &planner, HeuristicKind kind, float weight)
+{
+  planner.heuristic.kind = kind;
+  planner.heuristic.weight = weight;
+  clear_plan_cache(planner); // cached plans were found with different guarantees
 }
 
 static void set_planner_worldstate(const goap::Planner &planner, goap::WorldState &st, const char *st_name, int8_t val)
@@ -33,14 +53,12 @@ static void set_planner_worldstate(const goap::Planner &planner, goap::WorldStat
   auto itf = planner.wdesc.find(st_name);
   if (itf == planner.wdesc.end())
     return;
-  st[itf->second] = val;
+  st.set(itf->second, val);
 }
 
 goap::WorldState goap::produce_planner_worldstate(const Planner &planner, const WorldStateList &states)
 {
   WorldState res;
-  for (size_t i = 0; i < planner.wdesc.size(); ++i)
-    res.emplace_back(int8_t(-1));
   for (auto st : states)
     set_planner_worldstate(planner, res, st.first, int8_t(st.second));
   return res;
@@ -48,36 +66,15 @@ goap::WorldState goap::produce_planner_worldstate(const Planner &planner, const
 
 float goap::get_action_cost(const Planner &planner, size_t act_id)
 {
-  return planner.actions[act_id].cost;
+  return planner.actions.cost[act_id];
 }
 
-std::vector<size_t> goap::find_valid_state_transitions(const Planner &planner, const WorldState &from)
+void goap::find_valid_state_transitions(const Planner &planner, const WorldState &from, ActionMask &res)
 {
-  std::vector<size_t> res;
-
-  for (size_t i = 0; i < planner.actions.size(); ++i)
-  {
-    const Action &action = planner.actions[i];
-    bool isValidAction = true;
-    for (size_t j = 0; j < action.precondition.size() && isValidAction; ++j)
-      isValidAction &= action.precondition[j] < 0 || from[j] == action.precondition[j];
-    if (isValidAction)
-      res.emplace_back(i);
-  }
-  return res;
+  find_applicable_actions(planner.preconditionIndex, from, res);
 }
 
 goap::WorldState goap::apply_action(const Planner &planner, size_t act, const WorldState &from)
 {
-  WorldState res = from;
-  const Action &action = planner.actions[act];
-  for (size_t i = 0; i < action.effect.size(); ++i)
-  {
-    if (!action.setBitset[i])
-      res[i] += action.effect[i];
-    else if (action.effect[i] >= 0)
-      res[i] = action.effect[i];
-  }
-  return res;
+  return apply_action_effect(planner.actions, act, from);
 }
-
@@ -5,15 +5,62 @@
 
 #include "goapWorldState.h"
 #include "goapAction.h"
+#include "goapActionIndex.h"
+#include "goapHeuristic.h"
 
 namespace goap
 {
 
+  struct PlanStep
+  {
+    size_t action;
+    WorldState worldState;
+  };
+
+  struct PlanCacheStats
+  {
+    size_t hits = 0;
+    size_t misses = 0;
+    size_t evictions = 0;
+    size_t repairs = 0; // plans which had to replan some suffix
+    size_t repairedSteps = 0; // steps of old plans kept by repairs
+  };
+
+  // LRU cache of plans keyed by (start, goal) states, failed searches are cached too
+  struct PlanCache
+  {
+    static constexpr size_t no_entry = size_t(-1);
+
+    struct Entry
+    {
+      WorldState from;
+      WorldState to;
+      std::vector<PlanStep> plan;
+      float cost = 0.f;
+      bool found = false;
+      // recency list, intrusive so hits and evictions don't search
+      size_t newer = no_entry;
+      size_t older = no_entry;
+    };
+
+    size_t capacity = 64;
+    std::vector<Entry> entries;
+    size_t newest = no_entry;
+    size_t oldest = no_entry;
+    std::unordered_map<size_t, std::vector<size_t>> lookup; // key hash -> entry indices
+    PlanCacheStats stats;
+  };
+
   struct Planner
   {
     WorldDesc wdesc;
-    std::vector<Action> actions;
-    std::unordered_map<std::string, size_t> actionNames;
+    ActionTable actions;
+    // debug only, indexed by action id and by variable id
+    std::vector<std::string> actionNames;
+    std::vector<std::string> varNames;
+    PreconditionIndex preconditionIndex;
+    Heuristic heuristic;
+    PlanCache planCache;
   };
 
   Planner create_planner();
@@ -27,21 +74,49 @@ namespace goap
                                                                              const Effect &effect,
                                                                              const Effect &additive_effect);
 
-  void add_states_to_planner(Planner &planner, const std::vector<std::string> &state_names);
+  // weight > 1 trades plan quality for fewer expansions
+  void set_planner_heuristic(Planner &planner, HeuristicKind kind, float weight = 1.f);
+
+  // false if the packed world state is full, names past max_world_vars are not added then
+  bool add_states_to_planner(Planner &planner, const std::vector<std::string> &state_names);
   WorldState produce_planner_worldstate(const Planner &planner, const WorldStateList &states);
 
   float get_action_cost(const Planner &planner, size_t act_id);
 
-  std::vector<size_t> find_valid_state_transitions(const Planner &planner, const WorldState &from);
+  void find_valid_state_transitions(const Planner &planner, const WorldState &from, ActionMask &res);
   WorldState apply_action(const Planner &planner, size_t act, const WorldState &from);
 
-  struct PlanStep
+  struct PlanStats
   {
-    size_t action;
-    WorldState worldState;
+    size_t nodesExpanded = 0;
+    size_t nodesGenerated = 0;
+    size_t peakSearchBytes = 0; // estimated from the search containers, not measured
+  };
+
+  enum SearchMode
+  {
+    SEARCH_FORWARD, // progression from the current state
+    SEARCH_BACKWARD, // regression from the goal, small when goal constrains few variables
+    SEARCH_BIDIRECTIONAL // both at once until they meet, optimal with an admissible heuristic
+  };
+
+  struct PlanResult
+  {
+    float cost = 0.f;
+    bool found = false; // an empty plan with found set means the start already satisfies the goal
   };
 
-  float make_plan(const Planner &planner, const WorldState &from, const WorldState &to, std::vector<PlanStep> &plan);
+  // returns 0 both when there's no plan and when from already satisfies to, use PlanSearch to tell them apart
+  float make_plan(const Planner &planner, const WorldState &from, const WorldState &to, std::vector<PlanStep> &plan,
+                  SearchMode mode = SEARCH_FORWARD, PlanStats *stats = nullptr);
+  // same as make_plan, but returns a copy of a cached plan if one exists for this (from, to) pair
+  PlanResult make_cached_plan(Planner &planner, const WorldState &from, const WorldState &to, std::vector<PlanStep> &plan);
+  // checks plan against the new start state, keeps its valid prefix and replans only the rest, plan is cleared if the
+  // goal became unreachable
+  PlanResult repair_plan(Planner &planner, const WorldState &from, const WorldState &to, std::vector<PlanStep> &plan);
+  void set_plan_cache_capacity(Planner &planner, size_t capacity);
+  void clear_plan_cache(Planner &planner);
+
   void print_plan(const Planner &planner, const WorldState &init, const std::vector<PlanStep> &plan);
 };
 
@@ -1,11 +1,94 @@
 #pragma once
-#include <vector>
+#include <array>
+#include <cstdint>
 #include <unordered_map>
 #include <string>
 
 namespace goap
 {
-  using WorldState = std::vector<int8_t>;
+  // Every variable occupies one byte lane of a fixed array of 64-bit words,
+  // lane value -1 (0xff) means "unknown" for states and "don't care" for goals and preconditions.
+  constexpr size_t max_world_vars = 64;
+  constexpr size_t world_state_words = max_world_vars / 8;
+
+  using StateWords = std::array<uint64_t, world_state_words>;
+
+  constexpr uint64_t lane_high_bits = 0x8080808080808080ull;
+  constexpr uint64_t lane_low_bits = ~lane_high_bits;
+
+  // per lane add modulo 256, carries do not cross lanes
+  inline uint64_t lanes_add(uint64_t a, uint64_t b)
+  {
+    return ((a & lane_low_bits) + (b & lane_low_bits)) ^ ((a ^ b) & lane_high_bits);
+  }
+
+  // per lane two's complement negation
+  inline uint64_t lanes_neg(uint64_t a)
+  {
+    return lanes_add(~a, 0x0101010101010101ull);
+  }
+
+  // 0xff in every lane which isn't zero in v
+  inline uint64_t lanes_nonzero_mask(uint64_t v)
+  {
+    const uint64_t nonZero = (((v & lane_low_bits) + lane_low_bits) | v) & lane_high_bits;
+    return (nonZero >> 7) * 0xff;
+  }
+
+  // 0xff in every lane which isn't 0xff in v
+  inline uint64_t lanes_set_mask(uint64_t v)
+  {
+    return lanes_nonzero_mask(~v);
+  }
+
+  struct WorldState
+  {
+    StateWords words;
+
+    WorldState() { words.fill(~0ull); }
+
+    int8_t get(size_t idx) const
+    {
+      return int8_t(uint8_t(words[idx / 8] >> (idx % 8 * 8)));
+    }
+
+    void set(size_t idx, int8_t val)
+    {
+      const size_t shift = idx % 8 * 8;
+      words[idx / 8] = (words[idx / 8] & ~(0xffull << shift)) | (uint64_t(uint8_t(val)) << shift);
+    }
+
+    StateWords careMask() const
+    {
+      StateWords res;
+      for (size_t i = 0; i < world_state_words; ++i)
+        res[i] = lanes_set_mask(words[i]);
+      return res;
+    }
+
+    // true if every lane selected by care has the same value as in pattern
+    bool matches(const StateWords &pattern, const StateWords &care) const
+    {
+      uint64_t diff = 0;
+      for (size_t i = 0; i < world_state_words; ++i)
+        diff |= (words[i] ^ pattern[i]) & care[i];
+      return diff == 0;
+    }
+
+    size_t hash() const
+    {
+      uint64_t res = 0;
+      for (uint64_t w : words)
+        res = (res ^ w) * 0x9e3779b97f4a7c15ull;
+      // multiplication only moves entropy up, bring it back down to the low bits used for bucketing
+      res ^= res >> 33;
+      res *= 0xff51afd7ed558ccdull;
+      return res ^ (res >> 33);
+    }
+
+    bool operator==(const WorldState &rhs) const { return words == rhs.words; }
+    bool operator!=(const WorldState &rhs) const { return words != rhs.words; }
+  };
+
   using WorldDesc = std::unordered_map<std::string, size_t>;
 };
-
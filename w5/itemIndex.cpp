@@ -0,0 +1,55 @@
+#include "itemIndex.h"
+
+static void remove_item(ItemIndex &index, flecs::entity e)
+{
+  auto tile = index.tileOf.find(e.id());
+  if (tile == index.tileOf.end())
+    return;
+  auto [first, last] = index.byTile.equal_range(tile->second);
+  for (auto it = first; it != last; ++it)
+    if (it->second == e)
+    {
+      index.byTile.erase(it);
+      break;
+    }
+  index.tileOf.erase(tile);
+}
+
+// the index entity can be gone already when items are removed on world shutdown
+static ItemIndex *get_index(flecs::entity holder)
+{
+  return holder.is_alive() && holder.has<ItemIndex>() ? holder.get_mut<ItemIndex>() : nullptr;
+}
+
+template<typename ItemType>
+static void register_item_type(flecs::world &ecs, flecs::entity holder)
+{
+  // fires once both are there and on every later change of either of them
+  ecs.observer<const Position, const ItemType>()
+    .event(flecs::OnSet)
+    .each([holder](flecs::entity e, const Position &pos, const ItemType &)
+    {
+      ItemIndex *index = get_index(holder);
+      if (!index)
+        return;
+      remove_item(*index, e);
+      const int64_t key = tile_key(pos.x, pos.y);
+      index->byTile.emplace(key, e);
+      index->tileOf.emplace(e.id(), key);
+    });
+
+  ecs.observer<const Position, const ItemType>()
+    .event(flecs::OnRemove)
+    .each([holder](flecs::entity e, const Position &, const ItemType &)
+    {
+      if (ItemIndex *index = get_index(holder))
+        remove_item(*index, e);
+    });
+}
+
+void items::register_item_index(flecs::world &ecs)
+{
+  flecs::entity holder = ecs.entity("world").set(ItemIndex{});
+  register_item_type<HealAmount>(ecs, holder);
+  register_item_type<PowerupAmount>(ecs, holder);
+}
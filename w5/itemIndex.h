@@ -0,0 +1,27 @@
+#pragma once
+#include <flecs.h>
+#include <cstdint>
+#include <unordered_map>
+#include "ecsTypes.h"
+
+// Items lying on the map (HealAmount, PowerupAmount) by tile, lives on the "world" entity.
+// Kept up to date by observers, so a pickup check is one lookup no matter how many items there are.
+struct ItemIndex
+{
+  std::unordered_multimap<int64_t, flecs::entity> byTile;
+  std::unordered_map<uint64_t, int64_t> tileOf; // entity id -> key in byTile
+};
+
+namespace items
+{
+  // call before any item is created
+  void register_item_index(flecs::world &ecs);
+
+  template<typename Callable>
+  void for_each_item_at(const ItemIndex &index, const Position &pos, Callable c)
+  {
+    auto [first, last] = index.byTile.equal_range(tile_key(pos.x, pos.y));
+    for (auto it = first; it != last; ++it)
+      c(it->second);
+  }
+};
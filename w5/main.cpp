@@ -6,185 +6,167 @@
 #include "roguelike.h"
 #include "dungeonGen.h"
 #include "goapPlanner.h"
-
-enum EnemyDist
-{
-  DistMelee = 0,
-  DistRanged,
-  DistFar
-};
-
-enum HealthState
-{
-  Dead = 0,
-  Injured,
-  Healthy
-};
+#include "goapDomains.h"
+#include "goapBench.h"
+#include "rng.h"
+#include "viewCulling.h"
+#include "textureCache.h"
+#include "renderSnapshot.h"
+#include "simulation.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
 
 static void debug_enemy_planner()
 {
-  goap::Planner pl = goap::create_planner();
-
-  goap::add_states_to_planner(pl,
-      {"enemy_vis",
-       "enemy_alive",
-       "have_melee",
-       "have_ranged",
-       "enemy_dist",
-       "health_state"});
-
-  goap::add_action_to_planner(pl, "wander", 1,
-      {{"health_state", Healthy}},
-      {{"enemy_vis", 1}},
-      {});
-
-  goap::add_action_to_planner(pl, "approach_enemy", 1,
-      {{"health_state", Healthy}},
-      {},
-      {{"enemy_dist", -1}});
-
-  goap::add_action_to_planner(pl, "flee_enemy", 1,
-      {{"health_state", Healthy}},
-      {},
-      {{"enemy_dist", +1}});
-
-  goap::add_action_to_planner(pl, "find_melee", 1,
-      {{"have_melee", 0}, {"health_state", Healthy}},
-      {{"have_melee", 1}},
-      {});
-
-  goap::add_action_to_planner(pl, "find_ranged", 1,
-      {{"have_ranged", 0}, {"health_state", Healthy}},
-      {{"have_ranged", 1}},
-      {});
-
-  goap::add_action_to_planner(pl, "patch_up", 1,
-      {{"health_state", Injured}},
-      {},
-      {{"health_state", +1}});
-
-  goap::add_action_to_planner(pl, "attack_enemy", 1,
-      {{"enemy_vis", 1}, {"enemy_alive", 1}, {"have_melee", 1}, {"enemy_dist", DistMelee}, {"health_state", Healthy}},
-      {{"enemy_alive", 0}},
-      {{"health_state", -1}});
-
-  goap::add_action_to_planner(pl, "shoot_enemy", 1,
-      {{"enemy_vis", 1}, {"enemy_alive", 1}, {"have_ranged", 1}, {"enemy_dist", DistRanged}, {"health_state", Healthy}},
-      {{"enemy_alive", 0}},
-      {});
-
-  goap::WorldState ws = goap::produce_planner_worldstate(pl,
-      {{"enemy_vis", 0},
-       {"enemy_alive", 1},
-       {"have_melee", 0},
-       {"have_ranged", 0},
-       {"enemy_dist", DistFar},
-       {"health_state", Healthy}});
-
-  goap::WorldState goal = goap::produce_planner_worldstate(pl,
-      {{"enemy_alive", 0}, {"health_state", Healthy}});
+  goap::Domain dom = goap::create_enemy_domain();
 
   std::vector<goap::PlanStep> plan;
-  goap::make_plan(pl, ws, goal, plan);
-  goap::print_plan(pl, ws, plan);
+  goap::make_plan(dom.planner, dom.start, dom.goal, plan);
+  goap::print_plan(dom.planner, dom.start, plan);
 }
 
 static void debug_looter_planner()
 {
-  goap::Planner pl = goap::create_planner();
-
-  goap::add_states_to_planner(pl,
-      {"enemy_vis",
-       "loot_vis",
-       "num_loot",
-       "have_melee",
-       "have_ranged",
-       "enemy_dist",
-       "health_state",
-       "escaped"});
-
-  goap::add_action_to_planner(pl, "open_room", 1,
-      {{"health_state", Healthy}},
-      {{"enemy_vis", 1}, {"loot_vis", 1}/*, {"enemy_dist", 2}*/},
-      {});
-
-  goap::add_action_to_planner(pl, "loot", 1,
-      {{"health_state", Healthy}, {"loot_vis", 1}, {"enemy_vis", 0}},
-      {{"loot_vis", 0}},
-      {{"num_loot", +1}});
-
-  goap::add_action_to_planner(pl, "approach_enemy", 1,
-      {{"health_state", Healthy}},
-      {},
-      {{"enemy_dist", -1}});
-
-  goap::add_action_to_planner(pl, "flee_enemy", 1,
-      {{"health_state", Healthy}},
-      {},
-      {{"enemy_dist", +1}});
-
-  goap::add_action_to_planner(pl, "find_melee", 1,
-      {{"have_melee", 0}, {"health_state", Healthy}},
-      {{"have_melee", 1}},
-      {});
-
-  goap::add_action_to_planner(pl, "find_ranged", 1,
-      {{"have_ranged", 0}, {"health_state", Healthy}},
-      {{"have_ranged", 1}},
-      {});
-
-  goap::add_action_to_planner(pl, "patch_up", 1,
-      {{"health_state", Injured}},
-      {},
-      {{"health_state", +1}});
-
-  goap::add_action_to_planner(pl, "attack_enemy", 1,
-      {{"enemy_vis", 1}, {"have_melee", 1}, {"enemy_dist", DistMelee}, {"health_state", Healthy}},
-      {{"enemy_vis", 0}},
-      {{"health_state", -1}});
-
-  goap::add_action_to_planner(pl, "shoot_enemy", 1,
-      {{"enemy_vis", 1}, {"have_ranged", 1}, {"enemy_dist", DistRanged}, {"health_state", Healthy}},
-      {{"enemy_vis", 0}},
-      {{"health_state", -1}});
-
-  goap::add_action_to_planner(pl, "escape", 1,
-      {{"health_state", Healthy}, {"num_loot", 5}},
-      {{"escaped", 1}},
-      {});
-
-  goap::WorldState ws = goap::produce_planner_worldstate(pl,
-      {{"enemy_vis", 0},
-       {"loot_vis", 0},
-       {"num_loot", 0},
-       {"have_melee", 1},
-       {"have_ranged", 0},
-       {"enemy_dist", DistFar},
-       {"health_state", Healthy},
-       {"escaped", 0}});
-
-  goap::WorldState goal = goap::produce_planner_worldstate(pl,
-      {{"num_loot", 5}, {"escaped", 1}, {"health_state", Healthy}});
+  goap::Domain dom = goap::create_looter_domain();
 
   std::vector<goap::PlanStep> plan;
-  goap::make_plan(pl, ws, goal, plan);
-  goap::print_plan(pl, ws, plan);
+  goap::make_plan(dom.planner, dom.start, dom.goal, plan);
+  goap::print_plan(dom.planner, dom.start, plan);
+}
+
+
+static void update_camera(Camera2D &cam, const RenderSnapshot &snapshot)
+{
+  if (!snapshot.playerAlive)
+    return;
+  const Position &pos = snapshot.playerPos;
+  cam.target.x += (pos.x * tile_size - cam.target.x) * 0.1f;
+  cam.target.y += (pos.y * tile_size - cam.target.y) * 0.1f;
+}
+
+// --dungeon drunk|bsp|cave|wfc anywhere in the arguments, drunk walk by default
+static DungeonGenerator *create_dungeon_generator(int argc, const char **argv, bool headless)
+{
+  const char *kind = "drunk";
+  for (int i = 1; i + 1 < argc; ++i)
+    if (strcmp(argv[i], "--dungeon") == 0)
+      kind = argv[i + 1];
+  if (strcmp(kind, "bsp") == 0)
+    return create_bsp_generator();
+  if (strcmp(kind, "cave") == 0)
+    return create_cave_generator();
+  if (strcmp(kind, "wfc") == 0)
+    return create_wfc_generator();
+  DrunkDungeonParams dungParams;
+  dungParams.quiet = headless;
+  return create_drunk_generator(dungParams);
 }
 
+constexpr size_t dung_width = 50;
+constexpr size_t dung_height = 50;
 
-static void update_camera(Camera2D &cam, flecs::world &ecs)
+static std::vector<char> generate_tiles(const DungeonGenerator &generator)
 {
-  static auto playerQuery = ecs.query<const Position, const IsPlayer>();
+  std::vector<char> tiles(dung_width * dung_height);
+  generator.generate(tiles.data(), dung_width, dung_height);
+  return tiles;
+}
+
+// no window and no rendering, the player is driven by AutoPlayer, turns run back to back
+static int run_headless(int num_turns, const DungeonGenerator &generator)
+{
+  flecs::world ecs;
+  const std::vector<char> tiles = generate_tiles(generator);
+  init_dungeon(ecs, tiles.data(), dung_width, dung_height);
+  init_roguelike(ecs, true);
+
+  auto turnQuery = ecs.query<const TurnCounter>();
+  auto monstersQuery = ecs.query<const Hitpoints, const Team>();
+  flecs::entity player = ecs.entity("player");
+
+  const auto start = std::chrono::steady_clock::now();
+  int numSteps = 0;
+  for (; numSteps < num_turns && player.is_alive(); ++numSteps)
+    process_turn(ecs);
+  const double sec = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  int turns = 0;
+  turnQuery.each([&](const TurnCounter &tc) { turns = tc.count; });
+  int numMonsters = 0;
+  monstersQuery.each([&](const Hitpoints &, const Team &team) { numMonsters += team.team != 0 ? 1 : 0; });
+  printf("headless: %d player actions, %d turns in %.3f s, %.0f actions/s, player %s, %d monsters left\n",
+         numSteps, turns, sec, double(numSteps) / std::max(sec, 1e-9), player.is_alive() ? "alive" : "dead",
+         numMonsters);
+  return 0;
+}
 
-  playerQuery.each([&](const Position &pos, const IsPlayer &)
+// frame time with num_textures texture entities, filters set by a per frame system vs once on set
+static int run_texture_bench(int num_textures)
+{
+  InitWindow(1280, 720, "texture bench");
+  const char *paths[] = {"assets/swordsman.png", "assets/minotaur.png", "assets/wall.png", "assets/floor.png"};
+  constexpr int numFrames = 300;
+  for (bool perFrame : {true, false})
   {
-    cam.target.x += (pos.x * tile_size - cam.target.x) * 0.1f;
-    cam.target.y += (pos.y * tile_size - cam.target.y) * 0.1f;
-  });
+    flecs::world ecs;
+    register_texture_cache(ecs);
+    for (int i = 0; i < num_textures; ++i)
+      ecs.entity().set(Texture2D{acquire_texture(paths[i % 4])});
+    if (perFrame)
+      ecs.system<Texture2D>()
+        .each([](Texture2D &tex)
+        {
+          SetTextureFilter(tex, TEXTURE_FILTER_POINT);
+        });
+
+    const auto start = std::chrono::steady_clock::now();
+    for (int frame = 0; frame < numFrames && !WindowShouldClose(); ++frame)
+    {
+      BeginDrawing();
+        ClearBackground(BLACK);
+        ecs.progress();
+      EndDrawing();
+    }
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    printf("%d textures, filter %s: %.3f ms/frame\n", num_textures, perFrame ? "every frame" : "once on set",
+           ms / numFrames);
+  }
+  CloseWindow();
+  return 0;
 }
 
-int main(int /*argc*/, const char ** /*argv*/)
+// --seed N anywhere in the arguments, otherwise seeded from the clock; the seed is always printed
+static void seed_random(int argc, const char **argv)
 {
+  uint32_t seed = uint32_t(std::chrono::system_clock::now().time_since_epoch().count());
+  for (int i = 1; i + 1 < argc; ++i)
+    if (strcmp(argv[i], "--seed") == 0)
+      seed = uint32_t(strtoul(argv[i + 1], nullptr, 10));
+  rng::seed(seed);
+  printf("seed: %u\n", seed);
+}
+
+int main(int argc, const char **argv)
+{
+  seed_random(argc, argv);
+  if (argc > 1 && strcmp(argv[1], "--bench-goap") == 0)
+  {
+    bench_goap_planners();
+    return 0;
+  }
+  if (argc > 1 && strcmp(argv[1], "--bench-textures") == 0)
+    return run_texture_bench(argc > 2 ? atoi(argv[2]) : 10000);
+  const bool headless = argc > 1 && strcmp(argv[1], "--headless") == 0;
+  DungeonGenerator *generator = create_dungeon_generator(argc, argv, headless);
+  if (headless)
+  {
+    const int res = run_headless(argc > 2 && argv[2][0] != '-' ? atoi(argv[2]) : 10000, *generator);
+    delete generator;
+    return res;
+  }
+
   int width = 1920;
   int height = 1080;
   InitWindow(width, height, "w3 AI MIPT");
@@ -198,39 +180,52 @@ int main(int /*argc*/, const char ** /*argv*/)
     SetWindowSize(width, height);
   }
 
-  flecs::world ecs;
-  {
-    constexpr size_t dungWidth = 50;
-    constexpr size_t dungHeight = 50;
-    char *tiles = new char[dungWidth * dungHeight];
-    gen_drunk_dungeon(tiles, dungWidth, dungHeight);
-    init_dungeon(ecs, tiles, dungWidth, dungHeight);
-  }
-  init_roguelike(ecs);
-  debug_enemy_planner();
-  debug_looter_planner();
-
-  Camera2D camera = { {0, 0}, {0, 0}, 0.f, 1.f };
-  camera.target = Vector2{ 0.f, 0.f };
-  camera.offset = Vector2{ width * 0.5f, height * 0.5f };
-  camera.rotation = 0.f;
-  camera.zoom = 0.125f;
-
-  SetTargetFPS(60);               // Set our game to run at 60 frames-per-second
-  while (!WindowShouldClose())
   {
-    process_turn(ecs);
-    update_camera(camera, ecs);
-
-    BeginDrawing();
-      ClearBackground(BLACK);
-      BeginMode2D(camera);
-        ecs.progress();
-      EndMode2D();
-      print_stats(ecs);
-      // Advance to next frame. Process submitted rendering primitives.
-    EndDrawing();
-  }
+    const std::vector<char> tiles = generate_tiles(*generator);
+    delete generator;
+    // --no-sim-thread runs turns inside the frame, as its own phase before drawing
+    bool simThread = true;
+    for (int i = 1; i < argc; ++i)
+      if (strcmp(argv[i], "--no-sim-thread") == 0)
+        simThread = false;
+    Simulation sim(tiles.data(), dung_width, dung_height, simThread);
+    flecs::world render;
+    init_render_world(render, tiles.data(), dung_width, dung_height);
+    SnapshotMirror mirror;
+    debug_enemy_planner();
+    debug_looter_planner();
+
+    Camera2D camera = { {0, 0}, {0, 0}, 0.f, 1.f };
+    camera.target = Vector2{ 0.f, 0.f };
+    camera.offset = Vector2{ width * 0.5f, height * 0.5f };
+    camera.rotation = 0.f;
+    camera.zoom = 0.125f;
+
+    SetTargetFPS(60);               // Set our game to run at 60 frames-per-second
+    while (!WindowShouldClose())
+    {
+      const int action = read_player_action();
+      if (action != EA_NOP)
+        sim.submitPlayerAction(action);
+      sim.update();
+
+      // the snapshot stays alive for this frame even if the simulation publishes a new one meanwhile
+      const std::shared_ptr<const RenderSnapshot> snapshot = sim.snapshot();
+      mirror.apply(render, *snapshot, GetTime());
+      mirror.interpolate(render, GetTime());
+      update_camera(camera, *snapshot);
+      update_render_view(render, camera);
+
+      BeginDrawing();
+        ClearBackground(BLACK);
+        BeginMode2D(camera);
+          render.progress();
+        EndMode2D();
+        print_stats(*snapshot);
+        // Advance to next frame. Process submitted rendering primitives.
+      EndDrawing();
+    }
+  } // both worlds release their textures while the window is still open
 
   CloseWindow();
 
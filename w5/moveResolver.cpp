@@ -0,0 +1,159 @@
+#include "moveResolver.h"
+#include <algorithm>
+
+// fixed, so the split of work and the order of the merged results don't depend on the thread count
+constexpr size_t chunk_size = 1024;
+
+moves::Resolver::Resolver(size_t num_threads) : numThreads(num_threads)
+{
+}
+
+template<typename Callable>
+static void for_each_chunk(ThreadPool *pool, size_t count, Callable fn)
+{
+  const size_t numChunks = (count + chunk_size - 1) / chunk_size;
+  auto runChunk = [&](size_t chunk)
+  {
+    const size_t end = std::min(count, (chunk + 1) * chunk_size);
+    fn(chunk, chunk * chunk_size, end);
+  };
+  if (pool && numChunks > 1)
+    pool->parallelFor(numChunks, runChunk);
+  else
+    for (size_t chunk = 0; chunk < numChunks; ++chunk)
+      runChunk(chunk);
+}
+
+// sorts runs in parallel and merges them pairwise, entries are unique so the order is the same as std::sort's
+template<typename T, typename Compare>
+static void parallel_sort(ThreadPool *pool, std::vector<T> &values, Compare cmp)
+{
+  const size_t runSize = chunk_size * 16;
+  const size_t count = values.size();
+  if (!pool || count <= runSize)
+  {
+    std::sort(values.begin(), values.end(), cmp);
+    return;
+  }
+  const size_t numRuns = (count + runSize - 1) / runSize;
+  pool->parallelFor(numRuns, [&](size_t run)
+  {
+    std::sort(values.begin() + ptrdiff_t(run * runSize), values.begin() + ptrdiff_t(std::min(count, (run + 1) * runSize)), cmp);
+  });
+  for (size_t width = runSize; width < count; width *= 2)
+    pool->parallelFor((count + 2 * width - 1) / (2 * width), [&](size_t pair)
+    {
+      const size_t begin = pair * 2 * width;
+      const size_t mid = std::min(count, begin + width);
+      const size_t end = std::min(count, begin + 2 * width);
+      std::inplace_merge(values.begin() + ptrdiff_t(begin), values.begin() + ptrdiff_t(mid),
+                         values.begin() + ptrdiff_t(end), cmp);
+    });
+}
+
+void moves::Resolver::resolve(const Bodies &bodies, Result &res)
+{
+  const size_t count = bodies.size();
+  auto byTile = [](const TileEntry &lhs, const TileEntry &rhs)
+  {
+    return lhs.key != rhs.key ? lhs.key < rhs.key : lhs.priority < rhs.priority;
+  };
+  if (!pool && numThreads != 1 && count > chunk_size)
+    pool = std::make_unique<ThreadPool>(numThreads);
+  res.moved.assign(count, 0);
+  res.attacker.clear();
+  res.target.clear();
+
+  occupied.resize(count);
+  for (size_t i = 0; i < count; ++i)
+    occupied[i] = {tile_key(bodies.from[i].x, bodies.from[i].y), bodies.priority[i], i};
+  parallel_sort(pool.get(), occupied, byTile);
+
+  // look at what stands on every target, bumps into enemies become attacks
+  state.resize(count);
+  occupantsBegin.resize(count);
+  occupantsEnd.resize(count);
+  chunkAttacks.resize((count + chunk_size - 1) / chunk_size);
+  for_each_chunk(pool.get(), count, [&](size_t chunk, size_t begin, size_t end)
+  {
+    std::vector<size_t> &attacks = chunkAttacks[chunk];
+    attacks.clear();
+    for (size_t i = begin; i < end; ++i)
+    {
+      occupantsBegin[i] = occupantsEnd[i] = 0;
+      if (bodies.to[i] == bodies.from[i])
+      {
+        state[i] = MOVE_STAY;
+        continue;
+      }
+      const int64_t key = tile_key(bodies.to[i].x, bodies.to[i].y);
+      auto first = std::lower_bound(occupied.begin(), occupied.end(), key,
+                                    [](const TileEntry &e, int64_t k) { return e.key < k; });
+      auto last = first;
+      bool attacked = false;
+      for (; last != occupied.end() && last->key == key; ++last)
+        if (bodies.team[last->idx] != bodies.team[i])
+        {
+          attacks.push_back(i);
+          attacks.push_back(last->idx);
+          attacked = true;
+        }
+      occupantsBegin[i] = size_t(first - occupied.begin());
+      occupantsEnd[i] = size_t(last - occupied.begin());
+      state[i] = attacked ? MOVE_STAY : first == last ? MOVE_GO : MOVE_PENDING;
+    }
+  });
+  for (const std::vector<size_t> &attacks : chunkAttacks)
+    for (size_t i = 0; i < attacks.size(); i += 2)
+    {
+      res.attacker.push_back(attacks[i]);
+      res.target.push_back(attacks[i + 1]);
+    }
+
+  // one mover per target tile, the rest stay
+  claims.clear();
+  for (size_t i = 0; i < count; ++i)
+    if (state[i] != MOVE_STAY)
+      claims.push_back({tile_key(bodies.to[i].x, bodies.to[i].y), bodies.priority[i], i});
+  parallel_sort(pool.get(), claims, byTile);
+  for (size_t i = 1; i < claims.size(); ++i)
+    if (claims[i].key == claims[i - 1].key)
+      state[claims[i].idx] = MOVE_STAY;
+
+  // a move into allies goes through once all of them go, and fails as soon as one of them stays
+  pending.clear();
+  for (size_t i = 0; i < count; ++i)
+    if (state[i] == MOVE_PENDING)
+      pending.push_back(i);
+  bool changed = true;
+  while (changed)
+  {
+    changed = false;
+    size_t numLeft = 0;
+    for (size_t i : pending)
+    {
+      bool allGo = true;
+      bool anyStays = false;
+      for (size_t o = occupantsBegin[i]; o < occupantsEnd[i]; ++o)
+      {
+        const MoveState occupantState = state[occupied[o].idx];
+        allGo &= occupantState == MOVE_GO;
+        anyStays |= occupantState == MOVE_STAY;
+      }
+      if (anyStays || allGo)
+      {
+        state[i] = anyStays ? MOVE_STAY : MOVE_GO;
+        changed = true;
+      }
+      else
+        pending[numLeft++] = i;
+    }
+    pending.resize(numLeft);
+  }
+  // only cycles are left, everyone in them waits for the next one, so they all rotate
+  for (size_t i : pending)
+    state[i] = MOVE_GO;
+
+  for (size_t i = 0; i < count; ++i)
+    res.moved[i] = state[i] == MOVE_GO ? 1 : 0;
+}
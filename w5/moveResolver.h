@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <flecs.h>
+#include "ecsTypes.h"
+#include "threadPool.h"
+
+namespace moves
+{
+  // Everything standing on a tile this turn. Bodies that don't move have to == from.
+  struct Bodies
+  {
+    std::vector<uint64_t> priority; // unique, the lowest one wins a contested tile (entity id)
+    std::vector<Position> from;
+    std::vector<Position> to;
+    std::vector<int> team;
+
+    void push(uint64_t prio, Position f, Position t, int tm)
+    {
+      priority.push_back(prio);
+      from.push_back(f);
+      to.push_back(t);
+      team.push_back(tm);
+    }
+    size_t size() const { return from.size(); }
+    void clear() { priority.clear(); from.clear(); to.clear(); team.clear(); }
+  };
+
+  struct Result
+  {
+    std::vector<uint8_t> moved; // per body, 1 - now stands on its target
+    // bumps into enemies, body indices, in body order
+    std::vector<size_t> attacker;
+    std::vector<size_t> target;
+  };
+
+  // Resolves all moves at once against the tiles everyone stood on at the start of the turn:
+  //  - moving into an enemy is an attack, the attacker stays;
+  //  - a tile wanted by several movers goes to the lowest priority, the rest stay;
+  //  - moving into an ally only works if the ally moves away too, so chains and swaps go through.
+  // Bodies are processed in fixed size chunks, so the result doesn't depend on the number of threads.
+  // The workers are only started on the first call with more than one chunk of bodies.
+  class Resolver
+  {
+  public:
+    explicit Resolver(size_t num_threads = 0); // 0 - one per hardware thread, 1 - never spawns threads
+
+    void resolve(const Bodies &bodies, Result &res);
+
+  private:
+    enum MoveState : uint8_t
+    {
+      MOVE_STAY,
+      MOVE_PENDING, // target has allies on it, depends on whether they leave
+      MOVE_GO
+    };
+
+    struct TileEntry
+    {
+      int64_t key;
+      uint64_t priority;
+      size_t idx;
+    };
+
+    std::vector<TileEntry> occupied; // by start tile
+    std::vector<TileEntry> claims; // by target tile
+    std::vector<size_t> occupantsBegin; // per body, range in occupied of its target tile
+    std::vector<size_t> occupantsEnd;
+    std::vector<MoveState> state;
+    std::vector<std::vector<size_t>> chunkAttacks; // attacker, target pairs per chunk
+    std::vector<size_t> pending;
+    size_t numThreads = 0;
+    std::unique_ptr<ThreadPool> pool; // null until there's enough work to split
+  };
+};
+
+// singleton-like component, lives on the "world" entity and keeps the buffers between turns
+struct MoveResolution
+{
+  std::shared_ptr<moves::Resolver> resolver;
+  moves::Bodies bodies;
+  moves::Result result;
+  std::vector<flecs::entity> entities; // per body
+  std::vector<float> damage; // per body, melee damage of movers
+  std::vector<size_t> moverBody; // body of every mover, in query order
+};
@@ -0,0 +1,161 @@
+#include "renderSnapshot.h"
+#include "dmapOverlay.h"
+#include "spriteBatch.h"
+#include "viewCulling.h"
+#include <algorithm>
+
+void capture_render_snapshot(flecs::world &ecs, RenderSnapshot &snapshot)
+{
+  static auto drawableQuery = ecs.query<const Position, const Color>();
+  static auto visualisedQuery = ecs.query<const VisualiseMap>();
+  static auto playerQuery = ecs.query<const IsPlayer, const Position, const Hitpoints, const MeleeDamage>();
+  static auto logQuery = ecs.query<const ActionLog>();
+  static auto dungeonDataQuery = ecs.query<const DungeonData>();
+
+  snapshot.entities.clear();
+  snapshot.textures.clear();
+  drawableQuery.each([&](flecs::entity e, const Position &pos, const Color &color)
+  {
+    SnapshotEntity se;
+    se.id = e.id();
+    se.pos = pos;
+    se.color = color;
+    if (flecs::entity tex = e.target<TextureSource>())
+    {
+      se.texture = tex.id();
+      // a handful of textures, a linear search is enough
+      auto sameId = [&](const SnapshotTexture &st) { return st.id == se.texture; };
+      if (std::none_of(snapshot.textures.begin(), snapshot.textures.end(), sameId))
+        snapshot.textures.push_back({se.texture, tex.name().c_str()});
+    }
+    if (const Hitpoints *hp = e.get<Hitpoints>())
+    {
+      se.hitpoints = hp->hitpoints;
+      se.hasHitpoints = true;
+    }
+    snapshot.entities.push_back(std::move(se));
+  });
+
+  snapshot.overlays.clear();
+  dungeonDataQuery.each([&](const DungeonData &dd)
+  {
+    visualisedQuery.each([&](flecs::entity e, const VisualiseMap &)
+    {
+      SnapshotOverlay overlay;
+      overlay.name = e.name().c_str();
+      gather_dmap_overlay_values(ecs, e, overlay.values, dd.width * dd.height);
+      snapshot.overlays.push_back(std::move(overlay));
+    });
+  });
+
+  snapshot.playerAlive = false;
+  playerQuery.each([&](const IsPlayer &, const Position &pos, const Hitpoints &hp, const MeleeDamage &dmg)
+  {
+    snapshot.playerAlive = true;
+    snapshot.playerPos = pos;
+    snapshot.playerHitpoints = hp.hitpoints;
+    snapshot.playerDamage = dmg.damage;
+  });
+
+  logQuery.each([&](const ActionLog &l) { snapshot.log = l; });
+}
+
+Vector2 interpolated_pos(flecs::entity e, const Position &pos, float alpha)
+{
+  const DrawFrom *from = e.get<DrawFrom>();
+  if (!from)
+    return Vector2{float(pos.x), float(pos.y)};
+  return Vector2{from->pos.x + (float(pos.x) - from->pos.x) * alpha,
+                 from->pos.y + (float(pos.y) - from->pos.y) * alpha};
+}
+
+float get_interpolation_alpha(flecs::world &render)
+{
+  static auto interpolationQuery = render.query<const SnapshotInterpolation>();
+  float alpha = 1.f;
+  interpolationQuery.each([&](const SnapshotInterpolation &si) { alpha = si.alpha; });
+  return alpha;
+}
+
+float SnapshotMirror::alphaAt(double time) const
+{
+  return float(std::clamp((time - appliedTime) / move_duration, 0.0, 1.0));
+}
+
+flecs::entity SnapshotMirror::findTexture(flecs::world &render, const RenderSnapshot &snapshot, uint64_t id)
+{
+  auto it = textures.find(id);
+  if (it != textures.end())
+    return it->second;
+  for (const SnapshotTexture &st : snapshot.textures)
+    if (st.id == id)
+      return textures.emplace(id, render.entity(st.name.c_str())).first->second;
+  return flecs::entity();
+}
+
+void SnapshotMirror::apply(flecs::world &render, const RenderSnapshot &snapshot, double time)
+{
+  if (snapshot.step == appliedStep)
+    return;
+  // a snapshot may come mid-slide, the next slide starts where the entity is drawn now
+  const float drawnAlpha = alphaAt(time);
+  appliedStep = snapshot.step;
+  appliedTime = time;
+
+  std::unordered_map<uint64_t, flecs::entity> next;
+  next.reserve(snapshot.entities.size());
+  for (const SnapshotEntity &se : snapshot.entities)
+  {
+    flecs::entity e;
+    Vector2 from = {float(se.pos.x), float(se.pos.y)};
+    auto it = mirrored.find(se.id);
+    if (it != mirrored.end())
+    {
+      e = it->second;
+      from = interpolated_pos(e, *e.get<Position>(), drawnAlpha);
+      mirrored.erase(it);
+    }
+    else
+    {
+      e = render.entity();
+      if (se.texture != 0)
+        if (flecs::entity tex = findTexture(render, snapshot, se.texture))
+          set_sprite(e, tex);
+    }
+    e.set(se.pos)
+      .set(DrawFrom{from})
+      .set(se.color);
+    if (se.hasHitpoints)
+      e.set(Hitpoints{se.hitpoints});
+    next.emplace(se.id, e);
+  }
+  // whatever is left is gone from the simulation
+  for (auto &pair : mirrored)
+    pair.second.destruct();
+  mirrored = std::move(next);
+
+  std::vector<flecs::entity> nextOverlays;
+  nextOverlays.reserve(snapshot.overlays.size());
+  for (const SnapshotOverlay &so : snapshot.overlays)
+  {
+    flecs::entity e = render.entity(so.name.c_str());
+    if (!e.has<DmapOverlay>())
+      e.set(DmapOverlay{});
+    DmapOverlay *overlay = e.get_mut<DmapOverlay>();
+    overlay->values = so.values;
+    overlay->dirty = true;
+    nextOverlays.push_back(e);
+  }
+  // maps no longer visualised, destructing unloads their textures
+  for (flecs::entity e : overlays)
+    if (std::find(nextOverlays.begin(), nextOverlays.end(), e) == nextOverlays.end())
+      e.destruct();
+  overlays = std::move(nextOverlays);
+  mark_render_view_dirty(render);
+}
+
+void SnapshotMirror::interpolate(flecs::world &render, double time) const
+{
+  render.entity("view")
+    .set(SnapshotInterpolation{alphaAt(time)});
+}
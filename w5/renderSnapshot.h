@@ -0,0 +1,85 @@
+#pragma once
+#include <flecs.h>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "raylib.h"
+#include "ecsTypes.h"
+
+// Everything the renderer needs from one simulation step. It's copied out of the simulation world,
+// so the simulation can go on with the next turn (on its own thread) while this one is drawn.
+struct SnapshotEntity
+{
+  uint64_t id = 0; // in the simulation world
+  Position pos;
+  Color color;
+  uint64_t texture = 0; // texture entity in the simulation world, 0 for plain rectangles
+  float hitpoints = 0.f;
+  bool hasHitpoints = false;
+};
+
+// names of the texture entities used this step, only one per texture and not per entity
+struct SnapshotTexture
+{
+  uint64_t id = 0; // in the simulation world
+  std::string name;
+};
+
+struct SnapshotOverlay
+{
+  std::string name;
+  std::vector<float> values; // per tile
+};
+
+struct RenderSnapshot
+{
+  uint64_t step = 0; // increases with every published snapshot
+  std::vector<SnapshotEntity> entities;
+  std::vector<SnapshotTexture> textures;
+  std::vector<SnapshotOverlay> overlays; // visualised dijkstra maps
+  ActionLog log; // formatted only when drawn
+  Position playerPos;
+  bool playerAlive = false;
+  float playerHitpoints = 0.f;
+  float playerDamage = 0.f;
+};
+
+void capture_render_snapshot(flecs::world &ecs, RenderSnapshot &snapshot);
+
+// Where a mirrored entity was drawn when the snapshot came, it's drawn sliding towards its Position.
+struct DrawFrom
+{
+  Vector2 pos;
+};
+
+// 0 right after a new snapshot, 1 once movement is finished, set on the "view" entity
+struct SnapshotInterpolation
+{
+  float alpha = 1.f;
+};
+
+// tile space position to draw e at
+Vector2 interpolated_pos(flecs::entity e, const Position &pos, float alpha);
+float get_interpolation_alpha(flecs::world &render);
+
+// Keeps render world entities in sync with the simulation snapshots, matched by simulation entity id.
+class SnapshotMirror
+{
+public:
+  // does nothing if this snapshot was already applied
+  void apply(flecs::world &render, const RenderSnapshot &snapshot, double time);
+  void interpolate(flecs::world &render, double time) const;
+
+  static constexpr double move_duration = 0.1; // seconds
+
+private:
+  float alphaAt(double time) const;
+  flecs::entity findTexture(flecs::world &render, const RenderSnapshot &snapshot, uint64_t id);
+
+  std::unordered_map<uint64_t, flecs::entity> mirrored;
+  std::unordered_map<uint64_t, flecs::entity> textures; // simulation texture id -> render texture entity
+  std::vector<flecs::entity> overlays;
+  uint64_t appliedStep = 0;
+  double appliedTime = 0.0;
+};
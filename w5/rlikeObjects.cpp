@@ -2,6 +2,7 @@
 #include "ecsTypes.h"
 #include "dungeonUtils.h"
 #include "blackboard.h"
+#include "spriteBatch.h"
 
 flecs::entity create_hive(flecs::entity e)
 {
@@ -9,23 +10,45 @@ flecs::entity create_hive(flecs::entity e)
   return e;
 }
 
-static Position find_free_dungeon_tile(flecs::world &ecs)
+static bool is_tile_occupied(flecs::world &ecs, Position pos)
 {
   static auto findMonstersQuery = ecs.query<const Position, const Hitpoints>();
-  bool done = false;
-  while (!done)
+  bool occupied = false;
+  findMonstersQuery.each([&](const Position &p, const Hitpoints&)
+  {
+    if (p == pos)
+      occupied = true;
+  });
+  return occupied;
+}
+
+// random tries first, then the first free tile of the largest region, if it's full the entity has to share
+static Position find_free_dungeon_tile(flecs::world &ecs)
+{
+  constexpr int max_random_tries = 64;
+  Position pos = dungeon::find_walkable_tile(ecs);
+  for (int i = 0; i < max_random_tries && is_tile_occupied(ecs, pos); ++i)
+    pos = dungeon::find_walkable_tile(ecs);
+  if (!is_tile_occupied(ecs, pos))
+    return pos;
+
+  static auto dungeonDataQuery = ecs.query<const DungeonData>();
+  dungeonDataQuery.each([&](const DungeonData &dd)
   {
-    done = true;
-    Position pos = dungeon::find_walkable_tile(ecs);
-    findMonstersQuery.each([&](const Position &p, const Hitpoints&)
-    {
-      if (p == pos)
-        done = false;
-    });
-    if (done)
-      return pos;
-  };
-  return {0, 0};
+    if (dd.regions.largest == dungeon::no_region)
+      return;
+    for (size_t y = 0; y < dd.height; ++y)
+      for (size_t x = 0; x < dd.width; ++x)
+      {
+        const Position tile{int(x), int(y)};
+        if (dd.regions.tileRegion[y * dd.width + x] == dd.regions.largest && !is_tile_occupied(ecs, tile))
+        {
+          pos = tile;
+          return;
+        }
+      }
+  });
+  return pos;
 }
 
 flecs::entity create_monster(flecs::world &ecs, Color col, const char *texture_src)
@@ -33,7 +56,7 @@ flecs::entity create_monster(flecs::world &ecs, Color col, const char *texture_s
   Position pos = find_free_dungeon_tile(ecs);
 
   flecs::entity textureSrc = ecs.entity(texture_src);
-  return ecs.entity()
+  flecs::entity e = ecs.entity()
     .set(Position{pos.x, pos.y})
     .set(MovePos{pos.x, pos.y})
     .set(Hitpoints{100.f})
@@ -44,6 +67,8 @@ flecs::entity create_monster(flecs::world &ecs, Color col, const char *texture_s
     .set(NumActions{1, 0})
     .set(MeleeDamage{20.f})
     .set(Blackboard{});
+  set_sprite(e, textureSrc);
+  return e;
 }
 
 void create_player(flecs::world &ecs, const char *texture_src)
@@ -51,18 +76,19 @@ void create_player(flecs::world &ecs, const char *texture_src)
   Position pos = find_free_dungeon_tile(ecs);
 
   flecs::entity textureSrc = ecs.entity(texture_src);
-  ecs.entity("player")
+  flecs::entity player = ecs.entity("player")
     .set(Position{pos.x, pos.y})
     .set(MovePos{pos.x, pos.y})
     .set(Hitpoints{100.f})
     .set(Action{EA_NOP})
     .add<IsPlayer>()
     .set(Team{0})
-    .set(PlayerInput{})
+    .add<PlayerInput>()
     .set(NumActions{2, 0})
     .set(Color{255, 255, 255, 255})
     .add<TextureSource>(textureSrc)
     .set(MeleeDamage{50.f});
+  set_sprite(player, textureSrc);
 }
 
 void create_heal(flecs::world &ecs, int x, int y, float amount)
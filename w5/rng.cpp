@@ -0,0 +1,27 @@
+#include "rng.h"
+#include <random>
+
+static uint32_t current_seed = 5489u; // mt19937 default
+static std::mt19937 engine;
+
+void rng::seed(uint32_t seed)
+{
+  current_seed = seed;
+  engine.seed(seed);
+}
+
+uint32_t rng::get_seed()
+{
+  return current_seed;
+}
+
+uint32_t rng::next()
+{
+  return uint32_t(engine());
+}
+
+int rng::rand_int(int min, int max)
+{
+  std::uniform_int_distribution<int> dist(min, max);
+  return dist(engine);
+}
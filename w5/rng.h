@@ -0,0 +1,56 @@
+#pragma once
+#include <cstdint>
+
+// Single seeded generator for everything random in the simulation (dungeon, spawns, AI walks),
+// so a run is reproducible from one seed. Not thread safe, one thread at a time: dungeon generation
+// and spawning on main before the simulation thread starts, then only the simulation thread.
+namespace rng
+{
+  void seed(uint32_t seed);
+  uint32_t get_seed();
+
+  uint32_t next();
+  int rand_int(int min, int max); // inclusive on both ends, same as GetRandomValue
+
+  // Small and fast generator for hot loops which need their own independent streams,
+  // e.g. one per worker, seeded from the service or from a parent stream.
+  struct Xoshiro256
+  {
+    uint64_t s[4];
+
+    explicit Xoshiro256(uint64_t seed)
+    {
+      // splitmix64 spreads even tiny or similar seeds over the whole state
+      for (uint64_t &v : s)
+      {
+        seed += 0x9e3779b97f4a7c15ull;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        v = z ^ (z >> 31);
+      }
+    }
+
+    uint64_t next()
+    {
+      const uint64_t res = rotl(s[1] * 5, 7) * 9;
+      const uint64_t t = s[1] << 17;
+      s[2] ^= s[0];
+      s[3] ^= s[1];
+      s[1] ^= s[2];
+      s[0] ^= s[3];
+      s[2] ^= t;
+      s[3] = rotl(s[3], 45);
+      return res;
+    }
+
+    // uniform in [0, n), multiply-shift instead of modulo
+    uint32_t below(uint32_t n)
+    {
+      return uint32_t(((next() >> 32) * n) >> 32);
+    }
+
+  private:
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+  };
+};
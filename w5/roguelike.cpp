@@ -10,180 +10,179 @@
 #include "dmapFollower.h"
 #include "dmapBeh.h"
 #include "rlikeObjects.h"
-
-
-static void register_roguelike_systems(flecs::world &ecs)
+#include "goapAgent.h"
+#include "aiUtils.h"
+#include "rng.h"
+#include "staticTileMap.h"
+#include "viewCulling.h"
+#include "spriteBatch.h"
+#include "dmapOverlay.h"
+#include "textureCache.h"
+#include "renderSnapshot.h"
+#include "combatEvents.h"
+#include "itemIndex.h"
+#include "moveResolver.h"
+#include <cstdio>
+
+
+static void register_render_systems(flecs::world &ecs)
 {
-  static auto dungeonDataQuery = ecs.query<const DungeonData>();
-  ecs.system<PlayerInput, Action, const IsPlayer>()
-    .each([&](PlayerInput &inp, Action &a, const IsPlayer)
-    {
-      bool left = IsKeyDown(KEY_LEFT);
-      bool right = IsKeyDown(KEY_RIGHT);
-      bool up = IsKeyDown(KEY_UP);
-      bool down = IsKeyDown(KEY_DOWN);
-      if (left && !inp.left)
-        a.action = EA_MOVE_LEFT;
-      if (right && !inp.right)
-        a.action = EA_MOVE_RIGHT;
-      if (up && !inp.up)
-        a.action = EA_MOVE_UP;
-      if (down && !inp.down)
-        a.action = EA_MOVE_DOWN;
-      inp.left = left;
-      inp.right = right;
-      inp.up = up;
-      inp.down = down;
-    });
-  ecs.system<const Position, const Color>()
-    .term<TextureSource>(flecs::Wildcard)
-    .term<BackgroundTile>()
-    .each([&](flecs::entity e, const Position &pos, const Color color)
-    {
-      const auto textureSrc = e.target<TextureSource>();
-      DrawTextureQuad(*textureSrc.get<Texture2D>(),
-          Vector2{1, 1}, Vector2{0, 0},
-          Rectangle{float(pos.x) * tile_size, float(pos.y) * tile_size, tile_size, tile_size}, color);
-    });
-  ecs.system<const Position, const Color>()
-    .term<TextureSource>(flecs::Wildcard).not_()
-    .each([&](const Position &pos, const Color color)
-    {
-      const Rectangle rect = {float(pos.x) * tile_size, float(pos.y) * tile_size, tile_size, tile_size};
-      DrawRectangleRec(rect, color);
-    });
-  ecs.system<const Position, const Color>()
-    .term<TextureSource>(flecs::Wildcard)
-    .term<BackgroundTile>().not_()
-    .each([&](flecs::entity e, const Position &pos, const Color color)
-    {
-      const auto textureSrc = e.target<TextureSource>();
-      DrawTextureQuad(*textureSrc.get<Texture2D>(),
-          Vector2{1, 1}, Vector2{0, 0},
-          Rectangle{float(pos.x) * tile_size, float(pos.y) * tile_size, tile_size, tile_size}, color);
-    });
-  ecs.system<const Position, const Hitpoints>()
-    .each([&](const Position &pos, const Hitpoints &hp)
+  // everything below is culled to the tiles seen by the camera, entities slide between snapshot positions
+  ecs.system<const StaticTileMap>()
+    .each([&](const StaticTileMap &map)
     {
-      constexpr float hpPadding = 0.05f;
-      const float hpWidth = 1.f - 2.f * hpPadding;
-      const Rectangle underRect = {float(pos.x + hpPadding) * tile_size, float(pos.y-0.25f) * tile_size,
-                                   hpWidth * tile_size, 0.1f * tile_size};
-      DrawRectangleRec(underRect, BLACK);
-      const Rectangle hpRect = {float(pos.x + hpPadding) * tile_size, float(pos.y-0.25f) * tile_size,
-                                hp.hitpoints / 100.f * hpWidth * tile_size, 0.1f * tile_size};
-      DrawRectangleRec(hpRect, RED);
+      draw_static_tilemap(map, get_visible_tiles(ecs));
     });
-
-  ecs.system<Texture2D>()
-    .each([&](Texture2D &tex)
+  ecs.system<const VisibleTiles, const SpatialGrid>()
+    .each([&](const VisibleTiles &vis, const SpatialGrid &grid)
     {
-      SetTextureFilter(tex, TEXTURE_FILTER_POINT);
+      const float alpha = get_interpolation_alpha(ecs);
+      for_each_visible_entity(vis, grid, [&](flecs::entity e, const Position &pos)
+      {
+        const Color *color = e.get<Color>();
+        if (!color || e.has<Sprite>())
+          return;
+        const Vector2 p = interpolated_pos(e, pos, alpha);
+        const Rectangle rect = {p.x * tile_size, p.y * tile_size, tile_size, tile_size};
+        DrawRectangleRec(rect, *color);
+      });
     });
-  ecs.system<const DmapWeights>()
-    .term<VisualiseMap>()
-    .each([&](const DmapWeights &wt)
+  ecs.system<const VisibleTiles, const SpatialGrid>()
+    .each([&](const VisibleTiles &vis, const SpatialGrid &grid)
     {
-      dungeonDataQuery.each([&](const DungeonData &dd)
+      const float alpha = get_interpolation_alpha(ecs);
+      static std::vector<SpriteInstance> sprites; // reused between frames
+      sprites.clear();
+      for_each_visible_entity(vis, grid, [&](flecs::entity e, const Position &pos)
       {
-        for (size_t y = 0; y < dd.height; ++y)
-          for (size_t x = 0; x < dd.width; ++x)
-          {
-            float sum = 0.f;
-            for (const auto &pair : wt.weights)
-            {
-              ecs.entity(pair.first.c_str()).get([&](const DijkstraMapData &dmap)
-              {
-                float v = dmap.map[y * dd.width + x];
-                if (v < 1e5f)
-                  sum += powf(v * pair.second.mult, pair.second.pow);
-                else
-                  sum += v;
-              });
-            }
-            if (sum < 1e5f)
-              DrawText(TextFormat("%.1f", sum),
-                  int((float(x) + 0.2f) * tile_size), int((float(y) + 0.5f) * tile_size), 150, WHITE);
-          }
+        const Sprite *sprite = e.get<Sprite>();
+        const Color *color = e.get<Color>();
+        if (!sprite || !color)
+          return;
+        const Vector2 p = interpolated_pos(e, pos, alpha);
+        sprites.push_back({sprite->texture.id, Rectangle{p.x * tile_size, p.y * tile_size, tile_size, tile_size}, *color});
       });
+      draw_sprite_batch(sprites);
     });
-  ecs.system<const DijkstraMapData>()
-    .term<VisualiseMap>()
-    .each([](const DijkstraMapData &dmap)
+  ecs.system<const VisibleTiles, const SpatialGrid>()
+    .each([&](const VisibleTiles &vis, const SpatialGrid &grid)
     {
-      dungeonDataQuery.each([&](const DungeonData &dd)
+      const float alpha = get_interpolation_alpha(ecs);
+      for_each_visible_entity(vis, grid, [&](flecs::entity e, const Position &pos)
       {
-        for (size_t y = 0; y < dd.height; ++y)
-          for (size_t x = 0; x < dd.width; ++x)
-          {
-            const float val = dmap.map[y * dd.width + x];
-            if (val < 1e5f)
-              DrawText(TextFormat("%.1f", val),
-                  int((float(x) + 0.2f) * tile_size), int((float(y) + 0.5f) * tile_size), 150, WHITE);
-          }
+        const Hitpoints *hp = e.get<Hitpoints>();
+        if (!hp)
+          return;
+        const Vector2 p = interpolated_pos(e, pos, alpha);
+        constexpr float hpPadding = 0.05f;
+        const float hpWidth = 1.f - 2.f * hpPadding;
+        const Rectangle underRect = {(p.x + hpPadding) * tile_size, (p.y - 0.25f) * tile_size,
+                                     hpWidth * tile_size, 0.1f * tile_size};
+        DrawRectangleRec(underRect, BLACK);
+        const Rectangle hpRect = {(p.x + hpPadding) * tile_size, (p.y - 0.25f) * tile_size,
+                                  hp->hitpoints / 100.f * hpWidth * tile_size, 0.1f * tile_size};
+        DrawRectangleRec(hpRect, RED);
       });
     });
+
+  register_dmap_overlay(ecs);
 }
 
 
-void init_roguelike(flecs::world &ecs)
+void init_render_world(flecs::world &ecs, const char *tiles, size_t w, size_t h)
 {
-  register_roguelike_systems(ecs);
-
+  register_texture_cache(ecs);
   ecs.entity("swordsman_tex")
-    .set(Texture2D{LoadTexture("assets/swordsman.png")});
+    .set(Texture2D{acquire_texture("assets/swordsman.png")});
   ecs.entity("minotaur_tex")
-    .set(Texture2D{LoadTexture("assets/minotaur.png")});
-
-  ecs.observer<Texture2D>()
-    .event(flecs::OnRemove)
-    .each([](Texture2D texture)
-      {
-        UnloadTexture(texture);
-      });
+    .set(Texture2D{acquire_texture("assets/minotaur.png")});
+  ecs.entity("wall_tex")
+    .set(Texture2D{acquire_texture("assets/wall.png")});
+  ecs.entity("floor_tex")
+    .set(Texture2D{acquire_texture("assets/floor.png")});
+
+  register_static_tilemap(ecs);
+  init_dungeon(ecs, tiles, w, h);
+  register_render_systems(ecs);
+  init_render_view(ecs);
+}
 
+void init_roguelike(flecs::world &ecs, bool auto_player)
+{
+  items::register_item_index(ecs);
   create_hive_monster(create_monster(ecs, Color{0xee, 0x00, 0xee, 0xff}, "minotaur_tex"));
   create_hive_monster(create_monster(ecs, Color{0xee, 0x00, 0xee, 0xff}, "minotaur_tex"));
   create_hive_monster(create_monster(ecs, Color{0x11, 0x11, 0x11, 0xff}, "minotaur_tex"));
   create_hive(create_player_fleer(create_monster(ecs, Color{0, 255, 0, 255}, "minotaur_tex")));
 
   create_player(ecs, "swordsman_tex");
+  if (auto_player)
+    ecs.entity("player")
+      .remove<PlayerInput>()
+      .set(AutoPlayer{});
 
   ecs.entity("world")
     .set(TurnCounter{})
-    .set(ActionLog{});
+    .set(ActionLog{})
+    .set(CombatEvents{})
+    .set(MoveResolution{std::make_shared<moves::Resolver>(), {}, {}, {}, {}, {}})
+    .set(GoapPlanningService{});
 }
 
-void init_dungeon(flecs::world &ecs, char *tiles, size_t w, size_t h)
+void init_dungeon(flecs::world &ecs, const char *tiles, size_t w, size_t h)
 {
-  flecs::entity wallTex = ecs.entity("wall_tex")
-    .set(Texture2D{LoadTexture("assets/wall.png")});
-  flecs::entity floorTex = ecs.entity("floor_tex")
-    .set(Texture2D{LoadTexture("assets/floor.png")});
-
-  std::vector<char> dungeonData;
-  dungeonData.resize(w * h);
-  for (size_t y = 0; y < h; ++y)
-    for (size_t x = 0; x < w; ++x)
-      dungeonData[y * w + x] = tiles[y * w + x];
+  std::vector<char> dungeonData(tiles, tiles + w * h);
+  DungeonData dd{dungeonData, w, h, {}};
+  dungeon::label_regions(tiles, w, h, dd.regions);
   ecs.entity("dungeon")
-    .set(DungeonData{dungeonData, w, h});
+    .set(std::move(dd));
+}
 
-  for (size_t y = 0; y < h; ++y)
-    for (size_t x = 0; x < w; ++x)
-    {
-      char tile = tiles[y * w + x];
-      flecs::entity tileEntity = ecs.entity()
-        .add<BackgroundTile>()
-        .set(Position{int(x), int(y)})
-        .set(Color{255, 255, 255, 255});
-      if (tile == dungeon::wall)
-        tileEntity.add<TextureSource>(wallTex);
-      else if (tile == dungeon::floor)
-        tileEntity.add<TextureSource>(floorTex);
-    }
+int read_player_action()
+{
+  if (IsKeyPressed(KEY_LEFT))
+    return EA_MOVE_LEFT;
+  if (IsKeyPressed(KEY_RIGHT))
+    return EA_MOVE_RIGHT;
+  if (IsKeyPressed(KEY_UP))
+    return EA_MOVE_UP;
+  if (IsKeyPressed(KEY_DOWN))
+    return EA_MOVE_DOWN;
+  return EA_NOP;
 }
 
+void set_player_action(flecs::world &ecs, int action)
+{
+  static auto playerInputQuery = ecs.query<const PlayerInput, Action>();
+  playerInputQuery.each([&](const PlayerInput &, Action &a) { a.action = action; });
+}
+
+// Headless stand-in for the keyboard: walk to the closest enemy and bump into it,
+// try a random direction when a wall blocked the last move or there is nobody left.
+static void process_auto_player(flecs::world &ecs)
+{
+  static auto autoPlayerQuery = ecs.query<const IsPlayer, AutoPlayer>();
+  autoPlayerQuery.each([&](flecs::entity e, const IsPlayer &, AutoPlayer &ap)
+  {
+    bool moved = false;
+    e.get([&](const Position &pos)
+    {
+      moved = !(pos == ap.lastPos);
+      ap.lastPos = pos;
+    });
+    bool hasEnemy = false;
+    on_closest_enemy_pos(ecs, e, [&](Action &a, const Position &pos, const Position &enemy_pos)
+    {
+      // blocked next to an enemy means we've attacked it, keep going
+      if (!moved && dist(pos, enemy_pos) > 1.f)
+        return;
+      a.action = move_towards(pos, enemy_pos);
+      hasEnemy = true;
+    });
+    if (!hasEnemy)
+      e.set([](Action &a) { a.action = rng::rand_int(EA_MOVE_START, EA_MOVE_END - 1); });
+  });
+}
 
 static bool is_player_acted(flecs::world &ecs)
 {
@@ -221,100 +220,128 @@ static Position move_pos(Position pos, int action)
   return pos;
 }
 
-static void push_to_log(flecs::world &ecs, const char *msg)
+void format_log_event(const LogEvent &ev, char *buf, size_t size)
 {
-  static auto queryLog = ecs.query<ActionLog, const TurnCounter>();
-  queryLog.each([&](ActionLog &l, const TurnCounter &c)
+  switch (ev.type)
   {
-    l.log.push_back(std::to_string(c.count) + ": " + msg);
-    if (l.log.size() > l.capacity)
-      l.log.erase(l.log.begin());
-  });
+    case LOG_HEAL_SELF:
+      snprintf(buf, size, "%d: Monster healed itself", ev.turn);
+      return;
+    case LOG_DAMAGE:
+      snprintf(buf, size, "%d: damaged entity for %.0f", ev.turn, double(ev.amount));
+      return;
+    case LOG_DEATH:
+      snprintf(buf, size, "%d: entity died", ev.turn);
+      return;
+  }
+  snprintf(buf, size, "%d: ?", ev.turn);
 }
 
-static void process_actions(flecs::world &ecs)
+// Moves entities and turns bumps into enemies into attack events, heals into heal events.
+// All intents are gathered first and resolved together, see moves::Resolver for the rules.
+static void resolve_actions(flecs::world &ecs, CombatEvents &events)
 {
   static auto processActions = ecs.query<Action, Position, MovePos, const MeleeDamage, const Team>();
-  static auto processHeals = ecs.query<Action, Hitpoints>();
-  static auto checkAttacks = ecs.query<const MovePos, Hitpoints, const Team>();
-  // Process all actions
-  ecs.defer([&]
+  static auto processHeals = ecs.query<Action, const Hitpoints>();
+  static auto gatherBodies = ecs.query<const MovePos, const Hitpoints, const Team>();
+  static auto resolutionQuery = ecs.query<MoveResolution>();
+
+  processHeals.each([&](flecs::entity entity, Action &a, const Hitpoints &)
   {
-    processHeals.each([&](Action &a, Hitpoints &hp)
-    {
-      if (a.action != EA_HEAL_SELF)
-        return;
-      a.action = EA_NOP;
-      push_to_log(ecs, "Monster healed itself");
-      hp.hitpoints += 10.f;
+    if (a.action != EA_HEAL_SELF)
+      return;
+    a.action = EA_NOP;
+    events.heals.push(entity, 10.f);
+  });
 
-    });
-    processActions.each([&](flecs::entity entity, Action &a, Position &pos, MovePos &mpos, const MeleeDamage &dmg, const Team &team)
+  resolutionQuery.each([&](MoveResolution &mr)
+  {
+    moves::Bodies &bodies = mr.bodies;
+    bodies.clear();
+    mr.entities.clear();
+    mr.damage.clear();
+    std::unordered_map<uint64_t, size_t> bodyIdx;
+    gatherBodies.each([&](flecs::entity entity, const MovePos &mpos, const Hitpoints &, const Team &team)
     {
-      Position nextPos = move_pos(pos, a.action);
-      bool blocked = !dungeon::is_tile_walkable(ecs, nextPos);
-      checkAttacks.each([&](flecs::entity enemy, const MovePos &epos, Hitpoints &hp, const Team &enemy_team)
-      {
-        if (entity != enemy && epos == nextPos)
-        {
-          blocked = true;
-          if (team.team != enemy_team.team)
-          {
-            push_to_log(ecs, "damaged entity");
-            hp.hitpoints -= dmg.damage;
-          }
-        }
-      });
-      if (blocked)
-        a.action = EA_NOP;
-      else
-        mpos = nextPos;
+      bodyIdx.emplace(entity.id(), bodies.size());
+      const Position pos{mpos.x, mpos.y};
+      bodies.push(entity.id(), pos, pos, team.team);
+      mr.entities.push_back(entity);
+      mr.damage.push_back(0.f);
     });
-    // now move
-    processActions.each([&](Action &a, Position &pos, MovePos &mpos, const MeleeDamage &, const Team&)
+
+    mr.moverBody.clear();
+    processActions.each([&](flecs::entity entity, Action &a, Position &pos, MovePos &, const MeleeDamage &dmg, const Team &team)
     {
-      pos = mpos;
-      a.action = EA_NOP;
+      auto it = bodyIdx.find(entity.id());
+      size_t body = it != bodyIdx.end() ? it->second : bodies.size();
+      if (it == bodyIdx.end())
+      {
+        bodies.push(entity.id(), pos, pos, team.team);
+        mr.entities.push_back(entity);
+        mr.damage.push_back(0.f);
+      }
+      const Position nextPos = move_pos(pos, a.action);
+      if (dungeon::is_tile_walkable(ecs, nextPos))
+        bodies.to[body] = nextPos;
+      mr.damage[body] = dmg.damage;
+      mr.moverBody.push_back(body);
     });
-  });
 
-  static auto deleteAllDead = ecs.query<const Hitpoints>();
-  ecs.defer([&]
-  {
-    deleteAllDead.each([&](flecs::entity entity, const Hitpoints &hp)
+    mr.resolver->resolve(bodies, mr.result);
+
+    const moves::Result &res = mr.result;
+    for (size_t i = 0; i < res.attacker.size(); ++i)
+      events.attacks.push(mr.entities[res.attacker[i]], mr.entities[res.target[i]], mr.damage[res.attacker[i]]);
+    // nothing was added or removed since the gather, so movers come in the same order
+    size_t moverIdx = 0;
+    processActions.each([&](Action &a, Position &pos, MovePos &mpos, const MeleeDamage &, const Team &)
     {
-      if (hp.hitpoints <= 0.f)
-        entity.destruct();
+      const size_t body = mr.moverBody[moverIdx++];
+      if (res.moved[body])
+      {
+        pos = bodies.to[body];
+        mpos = bodies.to[body];
+      }
+      a.action = EA_NOP;
     });
   });
+}
 
-  static auto playerPickup = ecs.query<const IsPlayer, const Position, Hitpoints, MeleeDamage>();
-  static auto healPickup = ecs.query<const Position, const HealAmount>();
-  static auto powerupPickup = ecs.query<const Position, const PowerupAmount>();
-  ecs.defer([&]
+static void gather_pickups(flecs::world &ecs, CombatEvents &events)
+{
+  static auto playerPickup = ecs.query<const IsPlayer, const Position, const Hitpoints>();
+  static auto itemIndexQuery = ecs.query<const ItemIndex>();
+  itemIndexQuery.each([&](const ItemIndex &index)
   {
-    playerPickup.each([&](const IsPlayer&, const Position &pos, Hitpoints &hp, MeleeDamage &dmg)
+    playerPickup.each([&](flecs::entity player, const IsPlayer&, const Position &pos, const Hitpoints &hp)
     {
-      healPickup.each([&](flecs::entity entity, const Position &ppos, const HealAmount &amt)
-      {
-        if (pos == ppos)
-        {
-          hp.hitpoints += amt.amount;
-          entity.destruct();
-        }
-      });
-      powerupPickup.each([&](flecs::entity entity, const Position &ppos, const PowerupAmount &amt)
+      if (hp.hitpoints <= 0.f) // died this turn, removed with the rest of the dead
+        return;
+      items::for_each_item_at(index, pos, [&](flecs::entity item)
       {
-        if (pos == ppos)
-        {
-          dmg.damage += amt.amount;
-          entity.destruct();
-        }
+        if (const HealAmount *amt = item.get<HealAmount>())
+          events.pickups.push(player, item, PICKUP_HEAL, amt->amount);
+        if (const PowerupAmount *amt = item.get<PowerupAmount>())
+          events.pickups.push(player, item, PICKUP_POWERUP, amt->amount);
       });
     });
   });
 }
 
+static void process_actions(flecs::world &ecs)
+{
+  CombatEvents *events = combat::begin_turn(ecs);
+  if (!events)
+    return;
+  resolve_actions(ecs, *events);
+  combat::apply_hitpoint_events(*events);
+  gather_pickups(ecs, *events);
+  combat::apply_pickup_events(*events);
+  combat::log_combat_events(ecs, *events);
+  combat::cleanup_combat_events(ecs, *events);
+}
+
 template<typename T>
 static void push_info_to_bb(Blackboard &bb, const char *name, const T &val)
 {
@@ -359,6 +386,9 @@ void process_turn(flecs::world &ecs)
   static auto stateMachineAct = ecs.query<StateMachine>();
   static auto behTreeUpdate = ecs.query<BehaviourTree, Blackboard>();
   static auto turnIncrementer = ecs.query<TurnCounter>();
+  // plans finished on worker threads are only handed to entities here, outside of any iteration
+  deliver_goap_plans(ecs);
+  process_auto_player(ecs);
   if (is_player_acted(ecs))
   {
     if (upd_player_actions_count(ecs))
@@ -403,24 +433,20 @@ void process_turn(flecs::world &ecs)
   }
 }
 
-void print_stats(flecs::world &ecs)
+void print_stats(const RenderSnapshot &snapshot)
 {
-  static auto playerStatsQuery = ecs.query<const IsPlayer, const Hitpoints, const MeleeDamage>();
-  playerStatsQuery.each([&](const IsPlayer &, const Hitpoints &hp, const MeleeDamage &dmg)
+  if (snapshot.playerAlive)
   {
-    DrawText(TextFormat("hp: %d", int(hp.hitpoints)), 20, 20, 20, WHITE);
-    DrawText(TextFormat("power: %d", int(dmg.damage)), 20, 40, 20, WHITE);
-  });
+    DrawText(TextFormat("hp: %d", int(snapshot.playerHitpoints)), 20, 20, 20, WHITE);
+    DrawText(TextFormat("power: %d", int(snapshot.playerDamage)), 20, 40, 20, WHITE);
+  }
 
-  static auto actionLogQuery = ecs.query<const ActionLog>();
-  actionLogQuery.each([&](const ActionLog &l)
+  int yPos = GetRenderHeight() - 20;
+  for (size_t i = 0; i < snapshot.log.count; ++i)
   {
-    int yPos = GetRenderHeight() - 20;
-    for (const std::string &msg : l.log)
-    {
-      DrawText(msg.c_str(), 20, yPos, 20, WHITE);
-      yPos -= 20;
-    }
-  });
+    char msg[64];
+    format_log_event(snapshot.log.at(i), msg, sizeof(msg));
+    DrawText(msg, 20, yPos, 20, WHITE);
+    yPos -= 20;
+  }
 }
-
@@ -4,7 +4,19 @@
 
 constexpr float tile_size = 512.f;
 
-void init_roguelike(flecs::world &ecs);
-void init_dungeon(flecs::world &ecs, char *tiles, size_t w, size_t h);
+struct RenderSnapshot;
+struct LogEvent;
+
+// The simulation world holds the game and never touches the window, the render world holds
+// textures, static tiles and mirrors of simulated entities taken from snapshots.
+// auto_player replaces keyboard input for headless runs
+void init_roguelike(flecs::world &ecs, bool auto_player = false);
+void init_dungeon(flecs::world &ecs, const char *tiles, size_t w, size_t h);
+void init_render_world(flecs::world &ecs, const char *tiles, size_t w, size_t h);
 void process_turn(flecs::world &ecs);
-void print_stats(flecs::world &ecs);
+
+// keyboard is read on the main thread, the action is handed to the simulation
+int read_player_action();
+void set_player_action(flecs::world &ecs, int action);
+void print_stats(const RenderSnapshot &snapshot);
+void format_log_event(const LogEvent &ev, char *buf, size_t size);
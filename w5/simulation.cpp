@@ -0,0 +1,86 @@
+#include "simulation.h"
+#include "roguelike.h"
+
+Simulation::Simulation(const char *tiles, size_t w, size_t h, bool threaded)
+{
+  init_dungeon(ecs, tiles, w, h);
+  init_roguelike(ecs);
+  auto first = std::make_shared<RenderSnapshot>();
+  capture_render_snapshot(ecs, *first);
+  first->step = ++numSteps;
+  latest = std::move(first);
+  if (threaded)
+    thread = std::thread([this]() { threadLoop(); });
+}
+
+Simulation::~Simulation()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  actionAvailable.notify_all();
+  if (thread.joinable())
+    thread.join();
+}
+
+void Simulation::submitPlayerAction(int action)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingActions.push_back(action);
+  }
+  actionAvailable.notify_one();
+}
+
+void Simulation::update()
+{
+  if (thread.joinable())
+    return;
+  while (true)
+  {
+    int action = 0;
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (pendingActions.empty())
+        return;
+      action = pendingActions.front();
+      pendingActions.pop_front();
+    }
+    step(action);
+  }
+}
+
+std::shared_ptr<const RenderSnapshot> Simulation::snapshot() const
+{
+  std::lock_guard<std::mutex> lock(mutex);
+  return latest;
+}
+
+void Simulation::step(int action)
+{
+  set_player_action(ecs, action);
+  process_turn(ecs);
+  // a fresh snapshot each step, the renderer may still hold the previous one
+  auto next = std::make_shared<RenderSnapshot>();
+  capture_render_snapshot(ecs, *next);
+  next->step = ++numSteps;
+  std::lock_guard<std::mutex> lock(mutex);
+  latest = std::move(next);
+}
+
+void Simulation::threadLoop()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true)
+  {
+    actionAvailable.wait(lock, [this]() { return stopping || !pendingActions.empty(); });
+    if (stopping)
+      return;
+    const int action = pendingActions.front();
+    pendingActions.pop_front();
+    lock.unlock();
+    step(action);
+    lock.lock();
+  }
+}
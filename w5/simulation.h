@@ -0,0 +1,39 @@
+#pragma once
+#include <flecs.h>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "renderSnapshot.h"
+
+// Owns the simulation world. Player actions go in, an immutable snapshot of the last finished
+// step comes out. Threaded, turns run on their own thread and a slow AI turn only delays the
+// next snapshot instead of stalling frames; otherwise they run in update() on the caller's thread.
+class Simulation
+{
+public:
+  Simulation(const char *tiles, size_t w, size_t h, bool threaded);
+  ~Simulation();
+
+  Simulation(const Simulation &) = delete;
+  Simulation &operator=(const Simulation &) = delete;
+
+  void submitPlayerAction(int action);
+  // runs queued steps when not threaded
+  void update();
+  std::shared_ptr<const RenderSnapshot> snapshot() const;
+
+private:
+  void step(int action);
+  void threadLoop();
+
+  flecs::world ecs;
+  uint64_t numSteps = 0;
+  mutable std::mutex mutex;
+  std::condition_variable actionAvailable;
+  std::deque<int> pendingActions;
+  std::shared_ptr<const RenderSnapshot> latest;
+  bool stopping = false;
+  std::thread thread; // last, started once everything else is set up
+};
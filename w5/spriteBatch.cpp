@@ -0,0 +1,45 @@
+#include "spriteBatch.h"
+#include "rlgl.h"
+#include <algorithm>
+
+void set_sprite(flecs::entity e, flecs::entity texture_src)
+{
+  if (const Texture2D *tex = texture_src.get<Texture2D>())
+    e.set(Sprite{*tex});
+}
+
+void draw_sprite_batch(std::vector<SpriteInstance> &sprites)
+{
+  // stable, so overlapping sprites of one texture keep their order
+  std::stable_sort(sprites.begin(), sprites.end(),
+      [](const SpriteInstance &lhs, const SpriteInstance &rhs) { return lhs.textureId < rhs.textureId; });
+
+  for (size_t begin = 0; begin < sprites.size();)
+  {
+    const unsigned int textureId = sprites[begin].textureId;
+    size_t end = begin;
+    rlSetTexture(textureId);
+    rlBegin(RL_QUADS);
+    for (; end < sprites.size() && sprites[end].textureId == textureId; ++end)
+    {
+      const SpriteInstance &sprite = sprites[end];
+      rlCheckRenderBatchLimit(4); // flushes a full batch and keeps texture and mode
+      rlColor4ub(sprite.tint.r, sprite.tint.g, sprite.tint.b, sprite.tint.a);
+      const float x0 = sprite.dest.x;
+      const float y0 = sprite.dest.y;
+      const float x1 = sprite.dest.x + sprite.dest.width;
+      const float y1 = sprite.dest.y + sprite.dest.height;
+      rlTexCoord2f(0.f, 0.f);
+      rlVertex2f(x0, y0);
+      rlTexCoord2f(0.f, 1.f);
+      rlVertex2f(x0, y1);
+      rlTexCoord2f(1.f, 1.f);
+      rlVertex2f(x1, y1);
+      rlTexCoord2f(1.f, 0.f);
+      rlVertex2f(x1, y0);
+    }
+    rlEnd();
+    begin = end;
+  }
+  rlSetTexture(0);
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include <flecs.h>
+#include <vector>
+#include "raylib.h"
+
+// Texture handle cached on the entity, so drawing doesn't resolve the TextureSource relationship every frame.
+struct Sprite
+{
+  Texture2D texture;
+};
+
+struct SpriteInstance
+{
+  unsigned int textureId;
+  Rectangle dest;
+  Color tint;
+};
+
+// caches texture of texture_src on e, nothing is set if it isn't loaded (simulation world)
+void set_sprite(flecs::entity e, flecs::entity texture_src);
+// groups by texture and submits quads through the rlgl batch, one draw call per texture
+void draw_sprite_batch(std::vector<SpriteInstance> &sprites);
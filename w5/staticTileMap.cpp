@@ -0,0 +1,133 @@
+#include "staticTileMap.h"
+#include "ecsTypes.h"
+#include "dungeonUtils.h"
+#include "roguelike.h"
+#include "rlgl.h"
+#include <algorithm>
+#include <utility>
+
+static_assert(static_tilemap_chunk_size * static_tilemap_chunk_size * 4 <= 65536);
+
+static Mesh build_chunk_mesh(const DungeonData &dd, size_t chunk_x, size_t chunk_y, char tile, size_t num_tiles)
+{
+  Mesh mesh = {};
+  mesh.vertexCount = int(num_tiles * 4);
+  mesh.triangleCount = int(num_tiles * 2);
+  mesh.vertices = static_cast<float *>(RL_CALLOC(num_tiles * 4 * 3, sizeof(float)));
+  mesh.texcoords = static_cast<float *>(RL_CALLOC(num_tiles * 4 * 2, sizeof(float)));
+  mesh.indices = static_cast<unsigned short *>(RL_CALLOC(num_tiles * 6, sizeof(unsigned short)));
+
+  const size_t x1 = std::min(dd.width, (chunk_x + 1) * static_tilemap_chunk_size);
+  const size_t y1 = std::min(dd.height, (chunk_y + 1) * static_tilemap_chunk_size);
+  size_t quad = 0;
+  for (size_t y = chunk_y * static_tilemap_chunk_size; y < y1; ++y)
+    for (size_t x = chunk_x * static_tilemap_chunk_size; x < x1; ++x)
+    {
+      if (dd.tiles[y * dd.width + x] != tile)
+        continue;
+      const float left = float(x) * tile_size;
+      const float top = float(y) * tile_size;
+      const float corners[4][4] = {
+        {left, top, 0.f, 0.f},
+        {left, top + tile_size, 0.f, 1.f},
+        {left + tile_size, top + tile_size, 1.f, 1.f},
+        {left + tile_size, top, 1.f, 0.f}};
+      for (size_t i = 0; i < 4; ++i)
+      {
+        const size_t v = quad * 4 + i;
+        mesh.vertices[v * 3 + 0] = corners[i][0];
+        mesh.vertices[v * 3 + 1] = corners[i][1];
+        mesh.texcoords[v * 2 + 0] = corners[i][2];
+        mesh.texcoords[v * 2 + 1] = corners[i][3];
+      }
+      const unsigned short base = static_cast<unsigned short>(quad * 4);
+      const unsigned short quadIndices[6] = {0, 1, 2, 0, 2, 3};
+      for (size_t i = 0; i < 6; ++i)
+        mesh.indices[quad * 6 + i] = static_cast<unsigned short>(base + quadIndices[i]);
+      quad++;
+    }
+  UploadMesh(&mesh, false);
+  return mesh;
+}
+
+static StaticTileMap build_static_tilemap(flecs::world &ecs, const DungeonData &dd)
+{
+  const std::pair<char, flecs::entity> tileTextures[] = {
+    {dungeon::wall, ecs.entity("wall_tex")},
+    {dungeon::floor, ecs.entity("floor_tex")}};
+
+  StaticTileMap res;
+  res.material = LoadMaterialDefault();
+  res.numChunksX = (dd.width + static_tilemap_chunk_size - 1) / static_tilemap_chunk_size;
+  res.numChunksY = (dd.height + static_tilemap_chunk_size - 1) / static_tilemap_chunk_size;
+  for (size_t cy = 0; cy < res.numChunksY; ++cy)
+    for (size_t cx = 0; cx < res.numChunksX; ++cx)
+    {
+      res.chunkStart.push_back(res.chunks.size());
+      for (const auto &[tile, texture] : tileTextures)
+      {
+        size_t numTiles = 0;
+        for (size_t y = cy * static_tilemap_chunk_size; y < std::min(dd.height, (cy + 1) * static_tilemap_chunk_size); ++y)
+          for (size_t x = cx * static_tilemap_chunk_size; x < std::min(dd.width, (cx + 1) * static_tilemap_chunk_size); ++x)
+            if (dd.tiles[y * dd.width + x] == tile)
+              numTiles++;
+        if (numTiles > 0)
+          res.chunks.push_back({build_chunk_mesh(dd, cx, cy, tile, numTiles), texture, cx, cy});
+      }
+    }
+  res.chunkStart.push_back(res.chunks.size());
+  return res;
+}
+
+void register_static_tilemap(flecs::world &ecs)
+{
+  ecs.observer<const DungeonData>()
+    .event(flecs::OnSet)
+    .each([](flecs::entity e, const DungeonData &dd)
+    {
+      flecs::world ecs = e.world();
+      e.remove<StaticTileMap>(); // old meshes are released by the observer below
+      e.set(build_static_tilemap(ecs, dd));
+    });
+
+  ecs.observer<StaticTileMap>()
+    .event(flecs::OnRemove)
+    .each([](StaticTileMap &map)
+    {
+      for (StaticTileMapChunk &chunk : map.chunks)
+        UnloadMesh(chunk.mesh);
+      RL_FREE(map.material.maps); // UnloadMaterial would unload the shared tile textures too
+      map.chunks.clear();
+    });
+}
+
+void draw_static_tilemap(const StaticTileMap &map, const VisibleTiles &vis)
+{
+  if (vis.x0 >= vis.x1 || vis.y0 >= vis.y1 || map.chunks.empty())
+    return;
+  // meshes skip the internal batch, flush it so the draw order stays as submitted
+  rlDrawRenderBatchActive();
+  // tiles are wound for y pointing down
+  rlDisableBackfaceCulling();
+  Material material = map.material;
+  const Matrix identity = {1.f, 0.f, 0.f, 0.f,
+                           0.f, 1.f, 0.f, 0.f,
+                           0.f, 0.f, 1.f, 0.f,
+                           0.f, 0.f, 0.f, 1.f};
+  const size_t cx0 = size_t(vis.x0) / static_tilemap_chunk_size;
+  const size_t cy0 = size_t(vis.y0) / static_tilemap_chunk_size;
+  const size_t cx1 = std::min(map.numChunksX - 1, size_t(vis.x1 - 1) / static_tilemap_chunk_size);
+  const size_t cy1 = std::min(map.numChunksY - 1, size_t(vis.y1 - 1) / static_tilemap_chunk_size);
+  for (size_t cy = cy0; cy <= cy1; ++cy)
+    for (size_t cx = cx0; cx <= cx1; ++cx)
+    {
+      const size_t chunkIdx = cy * map.numChunksX + cx;
+      for (size_t i = map.chunkStart[chunkIdx]; i < map.chunkStart[chunkIdx + 1]; ++i)
+      {
+        const StaticTileMapChunk &chunk = map.chunks[i];
+        material.maps[MATERIAL_MAP_DIFFUSE].texture = *chunk.texture.get<Texture2D>();
+        DrawMesh(chunk.mesh, material, identity);
+      }
+    }
+  rlEnableBackfaceCulling();
+}
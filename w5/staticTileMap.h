@@ -0,0 +1,31 @@
+#pragma once
+#include <flecs.h>
+#include <vector>
+#include "raylib.h"
+#include "viewCulling.h"
+
+// Background tiles baked into meshes, one per texture per chunk of tiles, so the whole level
+// is drawn with a few draw calls instead of one entity and one quad per tile.
+constexpr size_t static_tilemap_chunk_size = 64; // 4 vertices per tile have to fit 16-bit indices
+
+struct StaticTileMapChunk
+{
+  Mesh mesh;
+  flecs::entity texture;
+  size_t chunkX = 0;
+  size_t chunkY = 0;
+};
+
+struct StaticTileMap
+{
+  std::vector<StaticTileMapChunk> chunks; // row major by chunk
+  size_t numChunksX = 0;
+  size_t numChunksY = 0;
+  std::vector<size_t> chunkStart; // numChunksX * numChunksY + 1 offsets into chunks
+  Material material; // default shader, diffuse texture is swapped per chunk
+};
+
+// rebuilds StaticTileMap on the dungeon entity every time DungeonData is set, textures must be loaded already
+void register_static_tilemap(flecs::world &ecs);
+// only chunks overlapping the visible tiles are drawn
+void draw_static_tilemap(const StaticTileMap &map, const VisibleTiles &vis);
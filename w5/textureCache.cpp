@@ -0,0 +1,66 @@
+#include "textureCache.h"
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+struct CachedTexture
+{
+  Texture2D texture;
+  size_t refs = 0;
+};
+
+static std::unordered_map<std::string, CachedTexture> textures_by_path;
+static std::unordered_map<unsigned int, std::string> path_by_id;
+// reference each entity holds through its Texture2D, so setting a new one releases the old one;
+// keyed by entity id, so only one world (the render one) may register the cache
+static std::unordered_map<uint64_t, Texture2D> texture_by_entity;
+
+Texture2D acquire_texture(const char *path)
+{
+  auto it = textures_by_path.find(path);
+  if (it == textures_by_path.end())
+  {
+    const Texture2D texture = LoadTexture(path);
+    if (texture.id == 0) // failed, raylib has logged why; not cached so a later acquire retries
+      return texture;
+    it = textures_by_path.emplace(path, CachedTexture{texture, 0}).first;
+    path_by_id[texture.id] = path;
+  }
+  it->second.refs++;
+  return it->second.texture;
+}
+
+void release_texture(Texture2D texture)
+{
+  auto pathIt = path_by_id.find(texture.id);
+  if (pathIt == path_by_id.end())
+    return;
+  auto it = textures_by_path.find(pathIt->second);
+  if (--it->second.refs > 0)
+    return;
+  UnloadTexture(it->second.texture);
+  textures_by_path.erase(it);
+  path_by_id.erase(pathIt);
+}
+
+void register_texture_cache(flecs::world &ecs)
+{
+  ecs.observer<const Texture2D>()
+    .event(flecs::OnSet)
+    .each([](flecs::entity e, const Texture2D &texture)
+    {
+      // the old value is already overwritten here, its reference is the one remembered below
+      auto held = texture_by_entity.find(e.id());
+      if (held != texture_by_entity.end())
+        release_texture(held->second);
+      texture_by_entity[e.id()] = texture;
+      SetTextureFilter(texture, TEXTURE_FILTER_POINT);
+    });
+  ecs.observer<const Texture2D>()
+    .event(flecs::OnRemove)
+    .each([](flecs::entity e, const Texture2D &texture)
+    {
+      texture_by_entity.erase(e.id());
+      release_texture(texture);
+    });
+}
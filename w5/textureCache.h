@@ -0,0 +1,12 @@
+#pragma once
+#include <flecs.h>
+#include "raylib.h"
+
+// Textures are loaded once per path and shared, every acquire needs a matching release and
+// the last release unloads. A Texture2D component holds one reference, released when it's removed.
+Texture2D acquire_texture(const char *path);
+void release_texture(Texture2D texture);
+
+// configures Texture2D components once when they are set and releases them on remove,
+// has to be called before any texture is set
+void register_texture_cache(flecs::world &ecs);
@@ -0,0 +1,56 @@
+#include "threadPool.h"
+#include <algorithm>
+
+ThreadPool::ThreadPool(size_t num_threads)
+{
+  if (num_threads == 0)
+    num_threads = std::max(1u, std::thread::hardware_concurrency());
+  for (size_t i = 0; i < num_threads; ++i)
+    workers.emplace_back([this]() { workerLoop(); });
+}
+
+ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    stopping = true;
+  }
+  jobAvailable.notify_all();
+  for (std::thread &worker : workers)
+    worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    jobs.push_back(std::move(job));
+  }
+  jobAvailable.notify_one();
+}
+
+void ThreadPool::waitIdle()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  idle.wait(lock, [this]() { return jobs.empty() && numBusy == 0; });
+}
+
+void ThreadPool::workerLoop()
+{
+  std::unique_lock<std::mutex> lock(mutex);
+  while (true)
+  {
+    jobAvailable.wait(lock, [this]() { return stopping || !jobs.empty(); });
+    if (jobs.empty()) // stopping and nothing left to do
+      return;
+    std::function<void()> job = std::move(jobs.front());
+    jobs.pop_front();
+    numBusy++;
+    lock.unlock();
+    job();
+    lock.lock();
+    numBusy--;
+    if (jobs.empty() && numBusy == 0)
+      idle.notify_all();
+  }
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <latch>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+  explicit ThreadPool(size_t num_threads = 0); // 0 - one per hardware thread
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  void submit(std::function<void()> job);
+  // blocks until the queue is empty and no job is running
+  void waitIdle();
+
+  // calls fn(i) for every i in [0, count) on the workers and returns once all calls are done,
+  // must not be called from a worker of the same pool
+  template<typename Callable>
+  void parallelFor(size_t count, Callable fn)
+  {
+    const size_t numJobs = std::min(count, workers.size());
+    std::atomic<size_t> nextIdx = 0;
+    std::latch done{ptrdiff_t(numJobs)};
+    for (size_t i = 0; i < numJobs; ++i)
+      submit([&]()
+      {
+        for (size_t idx = nextIdx++; idx < count; idx = nextIdx++)
+          fn(idx);
+        done.count_down();
+      });
+    done.wait();
+  }
+
+  size_t numThreads() const { return workers.size(); }
+
+private:
+  void workerLoop();
+
+  std::vector<std::thread> workers;
+  std::deque<std::function<void()>> jobs;
+  std::mutex mutex;
+  std::condition_variable jobAvailable;
+  std::condition_variable idle;
+  size_t numBusy = 0;
+  bool stopping = false;
+};
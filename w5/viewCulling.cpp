@@ -0,0 +1,73 @@
+#include "viewCulling.h"
+#include "roguelike.h"
+#include <algorithm>
+#include <cmath>
+
+void init_render_view(flecs::world &ecs)
+{
+  ecs.entity("view")
+    .set(VisibleTiles{})
+    .set(SpatialGrid{});
+}
+
+static void rebuild_spatial_grid(flecs::world &ecs, SpatialGrid &grid, const DungeonData &dd)
+{
+  static auto positionQuery = ecs.query<const Position>();
+
+  grid.width = (int(dd.width) + SpatialGrid::cell_size - 1) / SpatialGrid::cell_size;
+  grid.height = (int(dd.height) + SpatialGrid::cell_size - 1) / SpatialGrid::cell_size;
+  auto cellOf = [&](const Position &pos) -> size_t
+  {
+    const int cx = std::clamp(pos.x / SpatialGrid::cell_size, 0, grid.width - 1);
+    const int cy = std::clamp(pos.y / SpatialGrid::cell_size, 0, grid.height - 1);
+    return size_t(cy * grid.width + cx);
+  };
+
+  // counting sort by cell: sizes, offsets, then fill
+  grid.cellStart.assign(size_t(grid.width * grid.height) + 1, 0);
+  positionQuery.each([&](const Position &pos) { grid.cellStart[cellOf(pos) + 1]++; });
+  for (size_t i = 1; i < grid.cellStart.size(); ++i)
+    grid.cellStart[i] += grid.cellStart[i - 1];
+  grid.entities.resize(grid.cellStart.back());
+  std::vector<uint32_t> fill(grid.cellStart.begin(), grid.cellStart.end() - 1);
+  positionQuery.each([&](flecs::entity e, const Position &pos) { grid.entities[fill[cellOf(pos)]++] = e; });
+  grid.dirty = false;
+}
+
+void update_render_view(flecs::world &ecs, const Camera2D &camera)
+{
+  static auto dungeonDataQuery = ecs.query<const DungeonData>();
+  static auto viewQuery = ecs.query<VisibleTiles, SpatialGrid>();
+
+  dungeonDataQuery.each([&](const DungeonData &dd)
+  {
+    viewQuery.each([&](VisibleTiles &vis, SpatialGrid &grid)
+    {
+      const Vector2 topLeft = GetScreenToWorld2D(Vector2{0.f, 0.f}, camera);
+      const Vector2 bottomRight = GetScreenToWorld2D(Vector2{float(GetScreenWidth()), float(GetScreenHeight())}, camera);
+      // one tile of margin for things sticking out of their tile, like hp bars
+      vis.x0 = std::clamp(int(std::floor(std::min(topLeft.x, bottomRight.x) / tile_size)) - 1, 0, int(dd.width));
+      vis.y0 = std::clamp(int(std::floor(std::min(topLeft.y, bottomRight.y) / tile_size)) - 1, 0, int(dd.height));
+      vis.x1 = std::clamp(int(std::ceil(std::max(topLeft.x, bottomRight.x) / tile_size)) + 1, 0, int(dd.width));
+      vis.y1 = std::clamp(int(std::ceil(std::max(topLeft.y, bottomRight.y) / tile_size)) + 1, 0, int(dd.height));
+      const Vector2 mouse = GetScreenToWorld2D(GetMousePosition(), camera);
+      vis.cursor = Position{int(std::floor(mouse.x / tile_size)), int(std::floor(mouse.y / tile_size))};
+      if (grid.dirty)
+        rebuild_spatial_grid(ecs, grid, dd);
+    });
+  });
+}
+
+void mark_render_view_dirty(flecs::world &ecs)
+{
+  static auto gridQuery = ecs.query<SpatialGrid>();
+  gridQuery.each([](SpatialGrid &grid) { grid.dirty = true; });
+}
+
+VisibleTiles get_visible_tiles(flecs::world &ecs)
+{
+  static auto visQuery = ecs.query<const VisibleTiles>();
+  VisibleTiles res;
+  visQuery.each([&](const VisibleTiles &vis) { res = vis; });
+  return res;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <flecs.h>
+#include <algorithm>
+#include <vector>
+#include "raylib.h"
+#include "ecsTypes.h"
+
+// Tiles covered by the camera plus a tile of margin, clamped to the dungeon, max is exclusive.
+struct VisibleTiles
+{
+  int x0 = 0;
+  int y0 = 0;
+  int x1 = 0;
+  int y1 = 0;
+  Position cursor = {-1, -1}; // tile under the mouse
+
+  bool contains(const Position &pos) const { return pos.x >= x0 && pos.x < x1 && pos.y >= y0 && pos.y < y1; }
+};
+
+// Entities with a position bucketed into square cells of tiles, all buckets share one array.
+// Positions only change during turns, so it's rebuilt when a turn marks it dirty rather than every frame.
+struct SpatialGrid
+{
+  static constexpr int cell_size = 8;
+  int width = 0; // in cells
+  int height = 0;
+  std::vector<uint32_t> cellStart; // width * height + 1 offsets into entities
+  std::vector<flecs::entity> entities;
+  bool dirty = true;
+};
+
+void init_render_view(flecs::world &ecs);
+// visible tiles from the camera, grid is rebuilt if needed
+void update_render_view(flecs::world &ecs, const Camera2D &camera);
+void mark_render_view_dirty(flecs::world &ecs);
+VisibleTiles get_visible_tiles(flecs::world &ecs);
+
+// calls c(entity, position) for alive entities in visible tiles, only cells overlapping the view are visited
+template<typename Callable>
+void for_each_visible_entity(const VisibleTiles &vis, const SpatialGrid &grid, Callable c)
+{
+  if (vis.x0 >= vis.x1 || vis.y0 >= vis.y1 || grid.width == 0)
+    return;
+  const int cx0 = vis.x0 / SpatialGrid::cell_size;
+  const int cy0 = vis.y0 / SpatialGrid::cell_size;
+  const int cx1 = std::min(grid.width - 1, (vis.x1 - 1) / SpatialGrid::cell_size);
+  const int cy1 = std::min(grid.height - 1, (vis.y1 - 1) / SpatialGrid::cell_size);
+  for (int cy = cy0; cy <= cy1; ++cy)
+    for (int cx = cx0; cx <= cx1; ++cx)
+    {
+      const size_t cell = size_t(cy * grid.width + cx);
+      for (uint32_t i = grid.cellStart[cell]; i < grid.cellStart[cell + 1]; ++i)
+      {
+        const flecs::entity e = grid.entities[i];
+        if (!e.is_alive())
+          continue;
+        const Position *pos = e.get<Position>();
+        if (pos && vis.contains(*pos))
+          c(e, *pos);
+      }
+    }
+}